@@ -0,0 +1,135 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "axis_history.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// From -32768 at the bottom to 32767 at the top
+static const char sparkline_levels[] = "_.,-~^\"'";
+#define SPARKLINE_LEVELS ((int)sizeof(sparkline_levels) - 1)
+
+void axis_history_init(AxisHistory* history, int num_axes)
+{
+  history->num_axes = num_axes;
+  history->rings = calloc((size_t)(num_axes > 0 ? num_axes : 1), sizeof(AxisRing));
+}
+
+void axis_history_free(AxisHistory* history)
+{
+  free(history->rings);
+  history->rings = NULL;
+  history->num_axes = 0;
+}
+
+void axis_history_add(AxisHistory* history, int axis, uint32_t time, int16_t value)
+{
+  AxisRing* ring = &history->rings[axis];
+  uint32_t idx = ring->count & (AXIS_HISTORY_SIZE - 1);
+
+  ring->times[idx] = time;
+  ring->values[idx] = value;
+  ring->count += 1;
+}
+
+void axis_history_copy(AxisHistory* dst, const AxisHistory* src)
+{
+  for(int axis = 0; axis < src->num_axes; ++axis)
+  {
+    const AxisRing* from = &src->rings[axis];
+    AxisRing* to = &dst->rings[axis];
+
+    uint32_t missing = from->count - to->count;
+    if (missing > AXIS_HISTORY_SIZE)
+    {
+      missing = AXIS_HISTORY_SIZE;
+    }
+
+    for(uint32_t i = from->count - missing; i != from->count; ++i)
+    {
+      to->times[i & (AXIS_HISTORY_SIZE - 1)] = from->times[i & (AXIS_HISTORY_SIZE - 1)];
+      to->values[i & (AXIS_HISTORY_SIZE - 1)] = from->values[i & (AXIS_HISTORY_SIZE - 1)];
+    }
+    to->count = from->count;
+  }
+}
+
+static char sparkline_char(int value)
+{
+  return sparkline_levels[(value + 32768) * SPARKLINE_LEVELS / 65536];
+}
+
+void axis_history_sparkline(const AxisHistory* history, int axis,
+                            uint32_t now, uint32_t window_ms,
+                            char* out, int width)
+{
+  const AxisRing* ring = &history->rings[axis];
+  uint32_t start = now - window_ms;
+  uint32_t available = ring->count < AXIS_HISTORY_SIZE ? ring->count : AXIS_HISTORY_SIZE;
+
+  // walk back to the oldest sample inside the window, the one before
+  // it gives the value the window starts with
+  uint32_t n = 0;
+  while (n < available &&
+         (int32_t)(ring->times[(ring->count - 1 - n) & (AXIS_HISTORY_SIZE - 1)] - start) > 0)
+  {
+    n += 1;
+  }
+
+  int held;
+  if (n < available)
+  {
+    held = ring->values[(ring->count - 1 - n) & (AXIS_HISTORY_SIZE - 1)];
+  }
+  else if (n > 0)
+  {
+    // everything before the window got overwritten or never existed
+    held = ring->values[(ring->count - n) & (AXIS_HISTORY_SIZE - 1)];
+  }
+  else
+  {
+    memset(out, ' ', (size_t)width);
+    out[width] = '\0';
+    return;
+  }
+
+  // n samples are inside the window, oldest first
+  uint32_t i = ring->count - n;
+  for(int x = 0; x < width; ++x)
+  {
+    uint32_t slice_end = start + (uint32_t)(((uint64_t)window_ms * (uint64_t)(x + 1)) / (uint64_t)width);
+    int first = held;
+    int extreme = held;
+
+    while (i != ring->count &&
+           (int32_t)(ring->times[i & (AXIS_HISTORY_SIZE - 1)] - slice_end) <= 0)
+    {
+      int value = ring->values[i & (AXIS_HISTORY_SIZE - 1)];
+      if (abs(value - first) > abs(extreme - first))
+      {
+        extreme = value;
+      }
+      held = value;
+      i += 1;
+    }
+
+    out[x] = sparkline_char(extreme);
+  }
+  out[width] = '\0';
+}
+
+/* EOF */
@@ -0,0 +1,65 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_AXIS_HISTORY_H
+#define HEADER_SDL_JSTEST_AXIS_HISTORY_H
+
+#include <stdint.h>
+
+// Samples kept per axis, a power of two, enough for one second of a
+// 1 kHz axis
+#define AXIS_HISTORY_SIZE 1024
+
+// The last AXIS_HISTORY_SIZE samples of one axis. Times and values are
+// kept in separate arrays, so a sparkline only walks the times until
+// it found its window. Each ring is one contiguous block.
+typedef struct
+{
+  uint32_t count; // samples ever added, the next one goes to count % SIZE
+  uint32_t times[AXIS_HISTORY_SIZE];
+  int16_t  values[AXIS_HISTORY_SIZE];
+} AxisRing;
+
+// History of all axes of a joystick, allocated once, adding a sample
+// never allocates
+typedef struct
+{
+  int num_axes;
+  AxisRing* rings;
+} AxisHistory;
+
+void axis_history_init(AxisHistory* history, int num_axes);
+void axis_history_free(AxisHistory* history);
+
+// Record a value, time is in milliseconds like SDL event timestamps
+void axis_history_add(AxisHistory* history, int axis, uint32_t time, int16_t value);
+
+// Bring dst up to date with src, only the samples added since the last
+// copy are copied. Both must have the same number of axes.
+void axis_history_copy(AxisHistory* dst, const AxisHistory* src);
+
+// Render the last window_ms milliseconds before now as width chars into
+// out, oldest on the left. Each char is one time slice and shows the
+// sample of that slice that is furthest away from the value the slice
+// started with, so that short spikes stay visible. out is terminated
+// with '\0' and needs width + 1 chars.
+void axis_history_sparkline(const AxisHistory* history, int axis,
+                            uint32_t now, uint32_t window_ms,
+                            char* out, int width);
+
+#endif
+
+/* EOF */
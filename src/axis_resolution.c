@@ -0,0 +1,194 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "axis_resolution.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longest distance between neighbouring values that is still taken as
+// a candidate for the step, anything wider is a hole
+#define MAX_STEP 1024
+
+// Axes with fewer effective bits than this get flagged in the summary
+#define LOW_BITS 10.0
+
+// Index of the first seen value at or after idx, -1 when there is none
+static int next_value(const AxisValues* values, int idx)
+{
+  while (idx < 65536)
+  {
+    uint64_t word = values->seen[idx / 64] >> (idx % 64);
+    if (word == 0)
+    {
+      // nothing left in this word
+      idx = (idx / 64 + 1) * 64;
+    }
+    else
+    {
+      while (!(word & 1))
+      {
+        word >>= 1;
+        idx += 1;
+      }
+      return idx;
+    }
+  }
+  return -1;
+}
+
+void axis_resolution_init(AxisResolution* res, int num_axes)
+{
+  res->num_axes = num_axes;
+  res->axes = calloc((size_t)(num_axes > 0 ? num_axes : 1), sizeof(AxisValues));
+}
+
+void axis_resolution_free(AxisResolution* res)
+{
+  free(res->axes);
+  res->axes = NULL;
+  res->num_axes = 0;
+}
+
+void axis_resolution_add(AxisResolution* res, int axis, int16_t value)
+{
+  AxisValues* values = &res->axes[axis];
+  int idx = value + 32768;
+  uint64_t bit = (uint64_t)1 << (idx % 64);
+
+  if (!(values->seen[idx / 64] & bit))
+  {
+    values->seen[idx / 64] |= bit;
+    values->distinct += 1;
+  }
+}
+
+void axis_resolution_copy(AxisResolution* dst, const AxisResolution* src)
+{
+  // values are never removed, so the same count means the same set
+  for(int axis = 0; axis < src->num_axes; ++axis)
+  {
+    if (dst->axes[axis].distinct != src->axes[axis].distinct)
+    {
+      memcpy(&dst->axes[axis], &src->axes[axis], sizeof(AxisValues));
+    }
+  }
+}
+
+void axis_resolution_analyze(const AxisResolution* res, int axis, AxisResolutionInfo* info)
+{
+  const AxisValues* values = &res->axes[axis];
+
+  memset(info, 0, sizeof(AxisResolutionInfo));
+  info->distinct = values->distinct;
+  if (values->distinct == 0)
+  {
+    return;
+  }
+
+  // the step is the most common distance between neighbours, the
+  // smallest one wins a tie
+  uint32_t counts[MAX_STEP + 1];
+  memset(counts, 0, sizeof(counts));
+
+  int first = next_value(values, 0);
+  int last = first;
+  int min_dist = 65536;
+  for(int idx = next_value(values, first + 1); idx >= 0; idx = next_value(values, idx + 1))
+  {
+    int dist = idx - last;
+    if (dist <= MAX_STEP)
+    {
+      counts[dist] += 1;
+    }
+    if (dist < min_dist)
+    {
+      min_dist = dist;
+    }
+    last = idx;
+  }
+
+  info->min = first - 32768;
+  info->max = last - 32768;
+  info->coverage = (double)(last - first) / 65535.0;
+
+  if (values->distinct < 2)
+  {
+    return;
+  }
+
+  int best = 0;
+  for(int dist = 1; dist <= MAX_STEP; ++dist)
+  {
+    if (counts[dist] > counts[best])
+    {
+      best = dist;
+    }
+  }
+  // only holes, the values are too far apart to tell the step
+  info->step = best ? best : min_dist;
+
+  info->bits = log2(65536.0 / info->step);
+
+  int dead = AXIS_RESOLUTION_DEAD_STEPS * info->step;
+  int prev = first;
+  for(int idx = next_value(values, first + 1); idx >= 0; idx = next_value(values, idx + 1))
+  {
+    if (idx - prev > dead)
+    {
+      if (info->gaps == 0 || idx - prev - 2 > info->gap_max - info->gap_min)
+      {
+        info->gap_min = prev + 1 - 32768;
+        info->gap_max = idx - 1 - 32768;
+      }
+      info->gaps += 1;
+    }
+    prev = idx;
+  }
+}
+
+void axis_resolution_print(const AxisResolution* res, FILE* out)
+{
+  for(int axis = 0; axis < res->num_axes; ++axis)
+  {
+    AxisResolutionInfo info;
+    axis_resolution_analyze(res, axis, &info);
+
+    fprintf(out, "  Axis %2d: %5u values", axis, info.distinct);
+    if (info.distinct < 2)
+    {
+      fprintf(out, ", not moved\n");
+    }
+    else
+    {
+      fprintf(out, " from %6d to %6d (%3.0f%% of the range), step %4d, %4.1f bits",
+              info.min, info.max, info.coverage * 100.0, info.step, info.bits);
+      if (info.gaps)
+      {
+        fprintf(out, ", %d dead range%s, widest %d to %d", info.gaps, info.gaps == 1 ? "" : "s",
+                info.gap_min, info.gap_max);
+      }
+      if (info.bits < LOW_BITS)
+      {
+        fprintf(out, "  (low resolution)");
+      }
+      fprintf(out, "\n");
+    }
+  }
+}
+
+/* EOF */
@@ -0,0 +1,88 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_AXIS_RESOLUTION_H
+#define HEADER_SDL_JSTEST_AXIS_RESOLUTION_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// One bit for each of the 65536 values an axis can report
+#define AXIS_RESOLUTION_WORDS (65536 / 64)
+
+// Holes between two reported values that are wider than this many
+// steps count as dead ranges
+#define AXIS_RESOLUTION_DEAD_STEPS 4
+
+// The set of distinct values an axis ever reported. Bit v + 32768 is
+// set once value v was seen, so an axis takes 8kB no matter how long
+// it is tested and adding a value never allocates.
+typedef struct
+{
+  uint32_t distinct;
+  uint64_t seen[AXIS_RESOLUTION_WORDS];
+} AxisValues;
+
+typedef struct
+{
+  int num_axes;
+  AxisValues* axes;
+} AxisResolution;
+
+// What the values of an axis tell about its hardware
+typedef struct
+{
+  uint32_t distinct;
+  int min;
+  int max;
+
+  // most common distance between neighbouring values, an 8bit axis
+  // scaled up to 16bit reports every 256th value or so. 0 with less
+  // than two values.
+  int step;
+
+  // bits needed for the levels of the full axis span at that step,
+  // independent of how far the axis was moved
+  double bits;
+
+  // part of the full axis span between min and max, 0 to 1
+  double coverage;
+
+  // holes of more than AXIS_RESOLUTION_DEAD_STEPS steps between
+  // neighbouring values, the widest one goes from gap_min to gap_max,
+  // both values that were never seen
+  int gaps;
+  int gap_min;
+  int gap_max;
+} AxisResolutionInfo;
+
+void axis_resolution_init(AxisResolution* res, int num_axes);
+void axis_resolution_free(AxisResolution* res);
+
+void axis_resolution_add(AxisResolution* res, int axis, int16_t value);
+
+// Bring dst up to date with src, only axes that saw new values are
+// copied. Both must have the same number of axes.
+void axis_resolution_copy(AxisResolution* dst, const AxisResolution* src);
+
+void axis_resolution_analyze(const AxisResolution* res, int axis, AxisResolutionInfo* info);
+
+// Print the analysis of every axis
+void axis_resolution_print(const AxisResolution* res, FILE* out);
+
+#endif
+
+/* EOF */
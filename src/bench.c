@@ -0,0 +1,486 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Benchmarks of sdl2-jstest, run by 'make bench' and ctest. Everything
+// runs against SDL virtual joysticks under the dummy video driver, so
+// no hardware or display is needed:
+//
+//   startup  time for sdl2-jstest --timing to start, initialize SDL,
+//            load the mappings and exit
+//   list     time for sdl2-jstest --list
+//   ingest   events per second through event_ingest(), the per event
+//            work of --event: looking up the joystick, updating its
+//            state and rate and formatting the event
+//   render   time per frame of the --test view, taking a snapshot of
+//            the state and drawing what changed into a curses screen
+//            on /dev/null
+//
+// The results are written as a single JSON object, so they can be
+// kept around and compared between versions.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#include <SDL.h>
+#include <curses.h>
+
+#include "event_ingest.h"
+#include "histogram.h"
+#include "joystick_state.h"
+#include "joystick_view.h"
+#include "output.h"
+
+// Exit code that makes ctest report a benchmark as skipped
+#define BENCH_SKIPPED 77
+
+#define BENCH_AXES    6
+#define BENCH_BUTTONS 16
+#define BENCH_HATS    1
+
+extern char** environ;
+
+typedef struct
+{
+  char* binary;        // sdl2-jstest, for startup and list
+  const char* only;    // run just this benchmark
+  const char* output;  // JSON goes here instead of stdout
+  int quick;           // fewer iterations, for ctest
+} BenchOptions;
+
+static double counter_to_ms(Uint64 counter)
+{
+  return (double)counter * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static int bench_enabled(const BenchOptions* opts, const char* name)
+{
+  return !opts->only || strcmp(opts->only, name) == 0;
+}
+
+// Run the binary with args and wait for it, stdout and stderr go to
+// /dev/null. Returns the time it took in ms or a negative value on
+// error.
+static double run_binary(char* binary, char* arg)
+{
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+  posix_spawn_file_actions_addopen(&actions, 2, "/dev/null", O_WRONLY, 0);
+
+  char* argv[] = { binary, arg, NULL };
+  Uint64 start = SDL_GetPerformanceCounter();
+
+  pid_t pid;
+  int err = posix_spawn(&pid, binary, &actions, NULL, argv, environ);
+  posix_spawn_file_actions_destroy(&actions);
+  if (err != 0)
+  {
+    fprintf(stderr, "error: couldn't run '%s': %s\n", binary, strerror(err));
+    return -1.0;
+  }
+
+  int status;
+  while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+  {
+  }
+
+  double ms = counter_to_ms(SDL_GetPerformanceCounter() - start);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+  {
+    fprintf(stderr, "error: '%s %s' failed\n", binary, arg);
+    return -1.0;
+  }
+  return ms;
+}
+
+static void print_runs(FILE* out, const char* name, const char* arg, int runs, const double* ms)
+{
+  double sum = 0.0;
+  double min = ms[0];
+  double max = ms[0];
+  for(int i = 0; i < runs; ++i)
+  {
+    sum += ms[i];
+    min = SDL_min(min, ms[i]);
+    max = SDL_max(max, ms[i]);
+  }
+
+  fprintf(out, "    \"%s\": {\"command\": \"%s\", \"runs\": %d, \"mean_ms\": %.3f, \"min_ms\": %.3f, \"max_ms\": %.3f}",
+          name, arg, runs, sum / runs, min, max);
+}
+
+// startup and list
+static int bench_binary(const BenchOptions* opts, FILE* out, int* first, const char* name, char* arg)
+{
+  if (!opts->binary)
+  {
+    fprintf(stderr, "%s: skipped, no sdl2-jstest binary given\n", name);
+    return BENCH_SKIPPED;
+  }
+
+  int runs = opts->quick ? 3 : 30;
+  double* ms = malloc((size_t)runs * sizeof(double));
+
+  // one run to get the binary and its libraries into the page cache
+  if (run_binary(opts->binary, arg) < 0.0)
+  {
+    free(ms);
+    return 1;
+  }
+
+  for(int i = 0; i < runs; ++i)
+  {
+    ms[i] = run_binary(opts->binary, arg);
+    if (ms[i] < 0.0)
+    {
+      free(ms);
+      return 1;
+    }
+  }
+
+  fprintf(out, "%s\n", *first ? "" : ",");
+  *first = 0;
+  print_runs(out, name, arg, runs, ms);
+  free(ms);
+  return 0;
+}
+
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+
+static int attach_joystick(SDL_Joystick** joy)
+{
+  SDL_VirtualJoystickDesc desc;
+  memset(&desc, 0, sizeof(desc));
+  desc.version = SDL_VIRTUAL_JOYSTICK_DESC_VERSION;
+  desc.type = SDL_JOYSTICK_TYPE_UNKNOWN;
+  desc.naxes = BENCH_AXES;
+  desc.nbuttons = BENCH_BUTTONS;
+  desc.nhats = BENCH_HATS;
+  desc.name = "sdl2-jstest bench";
+
+  int device_index = SDL_JoystickAttachVirtualEx(&desc);
+  if (device_index < 0)
+  {
+    fprintf(stderr, "error: couldn't attach virtual joystick: %s\n", SDL_GetError());
+    return -1;
+  }
+
+  *joy = SDL_JoystickOpen(device_index);
+  if (!*joy)
+  {
+    fprintf(stderr, "error: couldn't open virtual joystick: %s\n", SDL_GetError());
+    SDL_JoystickDetachVirtual(device_index);
+    return -1;
+  }
+  return device_index;
+}
+
+// Change every control of the virtual joystick, the next pump turns
+// that into one event per control
+static void wiggle(SDL_Joystick* joy, int i)
+{
+  for(int axis = 0; axis < BENCH_AXES; ++axis)
+  {
+    SDL_JoystickSetVirtualAxis(joy, axis, (Sint16)((i * 997 + axis * 4099) % 65536 - 32768));
+  }
+  for(int button = 0; button < BENCH_BUTTONS; ++button)
+  {
+    SDL_JoystickSetVirtualButton(joy, button, (Uint8)((i + button) & 1));
+  }
+  for(int hat = 0; hat < BENCH_HATS; ++hat)
+  {
+    SDL_JoystickSetVirtualHat(joy, hat, (Uint8)(1 << (i % 4)));
+  }
+}
+
+static int bench_ingest(const BenchOptions* opts, FILE* out, int* first)
+{
+  SDL_Joystick* joy;
+  int device_index = attach_joystick(&joy);
+  if (device_index < 0)
+  {
+    return 1;
+  }
+
+  JoystickStateList list;
+  joystick_state_list_init(&list);
+  joystick_state_list_add(&list, joystick_state_open(device_index));
+
+  FILE* devnull = fopen("/dev/null", "w");
+  Output* output = output_open(OUTPUT_TEXT, devnull);
+
+  // --event without recording or measuring
+  EventIngest ingest;
+  ingest.list = &list;
+  ingest.recorder = NULL;
+  ingest.latency = NULL;
+  ingest.output = output;
+
+  int pumps = opts->quick ? 2000 : 50000;
+  Uint64 events = 0;
+  Uint64 busy = 0;
+
+  for(int i = 0; i < pumps; ++i)
+  {
+    wiggle(joy, i);
+    SDL_PumpEvents();
+
+    // only the work per event is timed, not the pump that creates them
+    Uint64 start = SDL_GetPerformanceCounter();
+    SDL_Event event;
+    while (SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) > 0)
+    {
+      event_ingest(&ingest, &event);
+      events += 1;
+    }
+    busy += SDL_GetPerformanceCounter() - start;
+  }
+
+  output_close(output);
+  fclose(devnull);
+  joystick_state_list_free(&list);
+  SDL_JoystickClose(joy);
+  SDL_JoystickDetachVirtual(device_index);
+
+  double ms = counter_to_ms(busy);
+  fprintf(out, "%s\n", *first ? "" : ",");
+  *first = 0;
+  fprintf(out, "    \"ingest\": {\"events\": %llu, \"busy_ms\": %.3f, \"events_per_sec\": %.0f}",
+          (unsigned long long)events, ms, ms > 0.0 ? (double)events * 1000.0 / ms : 0.0);
+  return events > 0 ? 0 : 1;
+}
+
+static int bench_render(const BenchOptions* opts, FILE* out, int* first)
+{
+  SDL_Joystick* joy;
+  int device_index = attach_joystick(&joy);
+  if (device_index < 0)
+  {
+    return 1;
+  }
+
+  JoystickStateList list;
+  JoystickStateList snapshot;
+  joystick_state_list_init(&list);
+  joystick_state_list_init(&snapshot);
+  joystick_state_list_add(&list, joystick_state_open(device_index));
+  JoystickState* state = list.states[0];
+
+  // a fixed size screen that goes nowhere
+  FILE* devnull_out = fopen("/dev/null", "w");
+  FILE* devnull_in = fopen("/dev/null", "r");
+  SCREEN* screen = newterm("xterm", devnull_out, devnull_in);
+  if (!screen)
+  {
+    // e.g. no terminfo entry for xterm, nothing sdl2-jstest can fix
+    fprintf(stderr, "render: skipped, couldn't create a curses screen\n");
+    fclose(devnull_in);
+    fclose(devnull_out);
+    joystick_state_list_free(&list);
+    SDL_JoystickClose(joy);
+    SDL_JoystickDetachVirtual(device_index);
+    return BENCH_SKIPPED;
+  }
+  set_term(screen);
+  resizeterm(50, 120);
+
+  JoystickView view;
+  joystick_view_init(&view);
+
+  Histogram* frame_us = malloc(sizeof(Histogram));
+  histogram_init(frame_us);
+  unsigned long cells = 0;
+  int frames = opts->quick ? 500 : 10000;
+
+  for(int i = 0; i < frames; ++i)
+  {
+    // every frame sees a full set of changes, like a joystick that
+    // is being moved all the time
+    wiggle(joy, i);
+    SDL_PumpEvents();
+    SDL_Event event;
+    while (SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) > 0)
+    {
+      joystick_state_handle_event(state, &event);
+    }
+
+    // what the render thread of test_joystick() does per frame
+    Uint64 start = SDL_GetPerformanceCounter();
+    joystick_state_list_copy(&snapshot, &list);
+    joystick_view_begin(&view);
+    joystick_view_draw(&view, stdscr, snapshot.states[0]);
+    refresh();
+    Uint64 end = SDL_GetPerformanceCounter();
+
+    histogram_add(frame_us, (uint32_t)(counter_to_ms(end - start) * 1000.0));
+    cells += view.cells;
+  }
+
+  joystick_view_free(&view);
+  endwin();
+  delscreen(screen);
+  fclose(devnull_in);
+  fclose(devnull_out);
+
+  joystick_state_list_free(&snapshot);
+  joystick_state_list_free(&list);
+  SDL_JoystickClose(joy);
+  SDL_JoystickDetachVirtual(device_index);
+
+  fprintf(out, "%s\n", *first ? "" : ",");
+  *first = 0;
+  fprintf(out, "    \"render\": {\"frames\": %d, \"mean_us\": %.1f, \"p50_us\": %u, \"p99_us\": %u,"
+          " \"max_us\": %u, \"cells_per_frame\": %.1f}",
+          frames, histogram_mean(frame_us),
+          histogram_percentile(frame_us, 50.0), histogram_percentile(frame_us, 99.0),
+          frame_us->max, (double)cells / frames);
+  free(frame_us);
+  return 0;
+}
+
+#else
+
+static int bench_ingest(const BenchOptions* opts, FILE* out, int* first)
+{
+  fprintf(stderr, "ingest: skipped, virtual joysticks require SDL 2.24.0 or newer\n");
+  return BENCH_SKIPPED;
+}
+
+static int bench_render(const BenchOptions* opts, FILE* out, int* first)
+{
+  fprintf(stderr, "render: skipped, virtual joysticks require SDL 2.24.0 or newer\n");
+  return BENCH_SKIPPED;
+}
+
+#endif
+
+static void print_help(const char* prg)
+{
+  printf("Usage: %s [OPTION]... [SDL2_JSTEST]\n", prg);
+  printf("Run the benchmarks of sdl2-jstest and print the results as JSON.\n");
+  printf("SDL2_JSTEST is the binary used for the startup and list benchmarks.\n");
+  printf("\n");
+  printf("Options:\n");
+  printf("  -h, --help             Print this help\n");
+  printf("  --only NAME            Only run startup, list, ingest or render\n");
+  printf("  --quick                Run fewer iterations\n");
+  printf("  --output FILE          Write the JSON to FILE instead of stdout\n");
+}
+
+int main(int argc, char** argv)
+{
+  BenchOptions opts;
+  memset(&opts, 0, sizeof(opts));
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
+    {
+      print_help(argv[0]);
+      return EXIT_SUCCESS;
+    }
+    else if (strcmp(argv[i], "--quick") == 0)
+    {
+      opts.quick = 1;
+    }
+    else if (strcmp(argv[i], "--only") == 0 && i + 1 < argc)
+    {
+      opts.only = argv[++i];
+    }
+    else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+    {
+      opts.output = argv[++i];
+    }
+    else if (argv[i][0] != '-' && !opts.binary)
+    {
+      opts.binary = argv[i];
+    }
+    else
+    {
+      fprintf(stderr, "%s: unknown argument '%s'\n", argv[0], argv[i]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  // the children inherit the dummy driver too
+  SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+  SDL_SetHint(SDL_HINT_JOYSTICK_ALLOW_BACKGROUND_EVENTS, "1");
+
+  if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK) < 0)
+  {
+    fprintf(stderr, "Unable to init SDL: %s\n", SDL_GetError());
+    return EXIT_FAILURE;
+  }
+
+  FILE* out = opts.output ? fopen(opts.output, "w") : stdout;
+  if (!out)
+  {
+    fprintf(stderr, "error: couldn't open '%s': %s\n", opts.output, strerror(errno));
+    SDL_Quit();
+    return EXIT_FAILURE;
+  }
+
+  fprintf(out, "{\n  \"version\": \"%s\",\n  \"quick\": %s,\n  \"results\": {",
+          SDL_JSTEST_VERSION, opts.quick ? "true" : "false");
+
+  int first = 1;
+  int failed = 0;
+  int skipped = 0;
+  int ret;
+
+#define RUN(name, call)                         \
+  if (bench_enabled(&opts, name))               \
+  {                                             \
+    ret = call;                                 \
+    failed += ret != 0 && ret != BENCH_SKIPPED; \
+    skipped += ret == BENCH_SKIPPED;            \
+  }
+
+  RUN("startup", bench_binary(&opts, out, &first, "startup", "--timing"));
+  RUN("list",    bench_binary(&opts, out, &first, "list", "--list"));
+  RUN("ingest",  bench_ingest(&opts, out, &first));
+  RUN("render",  bench_render(&opts, out, &first));
+
+#undef RUN
+
+  fprintf(out, "\n  }\n}\n");
+  if (opts.output)
+  {
+    fclose(out);
+  }
+  SDL_Quit();
+
+  if (failed)
+  {
+    return EXIT_FAILURE;
+  }
+  else if (skipped && first)
+  {
+    // nothing ran at all
+    return BENCH_SKIPPED;
+  }
+  else
+  {
+    return EXIT_SUCCESS;
+  }
+}
+
+/* EOF */
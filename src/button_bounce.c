@@ -0,0 +1,175 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "button_bounce.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void init_times(ButtonTimes* times)
+{
+  memset(times, 0, sizeof(ButtonTimes));
+  times->min_press = UINT32_MAX;
+  times->min_gap = UINT32_MAX;
+}
+
+static void print_lengths(const uint32_t* hist, int threshold_ms, FILE* out)
+{
+  for(int ms = 0; ms < threshold_ms; ++ms)
+  {
+    if (hist[ms])
+    {
+      fprintf(out, " %dms:%u", ms, hist[ms]);
+    }
+  }
+}
+
+void button_bounce_init(ButtonBounce* bounce, int num_buttons)
+{
+  bounce->num_buttons = num_buttons;
+  bounce->buttons = calloc((size_t)(num_buttons > 0 ? num_buttons : 1), sizeof(ButtonTimes));
+  for(int i = 0; i < num_buttons; ++i)
+  {
+    init_times(&bounce->buttons[i]);
+  }
+}
+
+void button_bounce_free(ButtonBounce* bounce)
+{
+  free(bounce->buttons);
+  bounce->buttons = NULL;
+  bounce->num_buttons = 0;
+}
+
+void button_bounce_reset(ButtonBounce* bounce, int button, int pressed, uint32_t time)
+{
+  ButtonTimes* times = &bounce->buttons[button];
+  times->pressed = pressed;
+  times->last_time = time;
+}
+
+void button_bounce_add(ButtonBounce* bounce, int button, int pressed, uint32_t time)
+{
+  ButtonTimes* times = &bounce->buttons[button];
+
+  // repeated events of the same state carry no length
+  if (times->pressed == pressed)
+  {
+    return;
+  }
+
+  uint32_t length = time - times->last_time;
+  if (pressed)
+  {
+    times->presses += 1;
+    if (times->transitions > 0)
+    {
+      times->min_gap = length < times->min_gap ? length : times->min_gap;
+      if (length < BUTTON_BOUNCE_MAX_MS)
+      {
+        times->gap_ms[length] += 1;
+      }
+    }
+  }
+  else if (times->transitions > 0)
+  {
+    times->min_press = length < times->min_press ? length : times->min_press;
+    if (length < BUTTON_BOUNCE_MAX_MS)
+    {
+      times->press_ms[length] += 1;
+    }
+  }
+
+  // the first transition only ends a state of unknown length
+  times->transitions += 1;
+  times->pressed = pressed;
+  times->last_time = time;
+}
+
+void button_bounce_copy(ButtonBounce* dst, const ButtonBounce* src)
+{
+  for(int i = 0; i < src->num_buttons; ++i)
+  {
+    if (dst->buttons[i].transitions != src->buttons[i].transitions)
+    {
+      dst->buttons[i] = src->buttons[i];
+    }
+  }
+}
+
+uint32_t button_bounce_count(const ButtonBounce* bounce, int button, int threshold_ms)
+{
+  const ButtonTimes* times = &bounce->buttons[button];
+  uint32_t count = 0;
+
+  for(int ms = 0; ms < threshold_ms && ms < BUTTON_BOUNCE_MAX_MS; ++ms)
+  {
+    count += times->press_ms[ms] + times->gap_ms[ms];
+  }
+  return count;
+}
+
+uint32_t button_bounce_total(const ButtonBounce* bounce, int threshold_ms)
+{
+  uint32_t count = 0;
+  for(int i = 0; i < bounce->num_buttons; ++i)
+  {
+    count += button_bounce_count(bounce, i, threshold_ms);
+  }
+  return count;
+}
+
+void button_bounce_print(const ButtonBounce* bounce, int threshold_ms, FILE* out)
+{
+  int used = 0;
+  for(int i = 0; i < bounce->num_buttons; ++i)
+  {
+    const ButtonTimes* times = &bounce->buttons[i];
+    if (times->transitions == 0)
+    {
+      continue;
+    }
+    used += 1;
+
+    uint32_t count = button_bounce_count(bounce, i, threshold_ms);
+    fprintf(out, "  Button %3d: %6u presses, %4u bounces", i, times->presses, count);
+    if (times->min_press != UINT32_MAX)
+    {
+      fprintf(out, ", shortest press %4u ms", times->min_press);
+    }
+    if (times->min_gap != UINT32_MAX)
+    {
+      fprintf(out, ", shortest gap %4u ms", times->min_gap);
+    }
+    fprintf(out, "\n");
+
+    if (count)
+    {
+      fprintf(out, "              presses:");
+      print_lengths(times->press_ms, threshold_ms, out);
+      fprintf(out, "\n              gaps:   ");
+      print_lengths(times->gap_ms, threshold_ms, out);
+      fprintf(out, "\n");
+    }
+  }
+
+  if (!used)
+  {
+    fprintf(out, "  No button was pressed\n");
+  }
+}
+
+/* EOF */
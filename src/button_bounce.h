@@ -0,0 +1,82 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_BUTTON_BOUNCE_H
+#define HEADER_SDL_JSTEST_BUTTON_BOUNCE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Presses and gaps between presses shorter than this are counted per
+// millisecond, the bounce threshold can be anything up to it
+#define BUTTON_BOUNCE_MAX_MS 64
+
+// How long a button was held and released, as seen through its events
+typedef struct
+{
+  uint32_t transitions;
+  uint32_t presses;
+  uint32_t last_time;
+  int pressed;
+
+  // shortest press and shortest gap between a release and the next
+  // press, UINT32_MAX until there was one
+  uint32_t min_press;
+  uint32_t min_gap;
+
+  // presses and gaps by their length in ms, longer ones aren't counted
+  uint32_t press_ms[BUTTON_BOUNCE_MAX_MS];
+  uint32_t gap_ms[BUTTON_BOUNCE_MAX_MS];
+} ButtonTimes;
+
+// A worn switch chatters, it sends a press and a release, or a release
+// and a press, within a few milliseconds where there should be a single
+// transition. Everything that is needed to count those for any
+// threshold up to BUTTON_BOUNCE_MAX_MS is kept per button.
+typedef struct
+{
+  int num_buttons;
+  ButtonTimes* buttons;
+} ButtonBounce;
+
+void button_bounce_init(ButtonBounce* bounce, int num_buttons);
+void button_bounce_free(ButtonBounce* bounce);
+
+// Set the initial state of a button without counting a transition
+void button_bounce_reset(ButtonBounce* bounce, int button, int pressed, uint32_t time);
+
+// Record a button event, time is in milliseconds like SDL event
+// timestamps
+void button_bounce_add(ButtonBounce* bounce, int button, int pressed, uint32_t time);
+
+// Bring dst up to date with src, only buttons that changed are
+// copied. Both must have the same number of buttons.
+void button_bounce_copy(ButtonBounce* dst, const ButtonBounce* src);
+
+// Presses and gaps of a button that were shorter than threshold_ms
+uint32_t button_bounce_count(const ButtonBounce* bounce, int button, int threshold_ms);
+
+// The same summed over all buttons
+uint32_t button_bounce_total(const ButtonBounce* bounce, int threshold_ms);
+
+// Print the buttons that were used, with their number of presses, the
+// shortest press and gap and a histogram of the presses and gaps below
+// threshold_ms
+void button_bounce_print(const ButtonBounce* bounce, int threshold_ms, FILE* out);
+
+#endif
+
+/* EOF */
@@ -0,0 +1,45 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "byte_order.h"
+
+Uint8* put_u16(Uint8* p, Uint16 v)
+{
+  p[0] = (Uint8)(v & 0xff);
+  p[1] = (Uint8)(v >> 8);
+  return p + 2;
+}
+
+Uint8* put_u32(Uint8* p, Uint32 v)
+{
+  p[0] = (Uint8)(v & 0xff);
+  p[1] = (Uint8)((v >> 8) & 0xff);
+  p[2] = (Uint8)((v >> 16) & 0xff);
+  p[3] = (Uint8)(v >> 24);
+  return p + 4;
+}
+
+Uint16 get_u16(const Uint8* p)
+{
+  return (Uint16)(p[0] | (p[1] << 8));
+}
+
+Uint32 get_u32(const Uint8* p)
+{
+  return (Uint32)p[0] | ((Uint32)p[1] << 8) | ((Uint32)p[2] << 16) | ((Uint32)p[3] << 24);
+}
+
+/* EOF */
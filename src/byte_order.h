@@ -0,0 +1,31 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_BYTE_ORDER_H
+#define HEADER_SDL_JSTEST_BYTE_ORDER_H
+
+#include <SDL.h>
+
+// Little endian numbers of the --record log and the binary --headless
+// snapshots. The put functions return the position after the value.
+Uint8* put_u16(Uint8* p, Uint16 v);
+Uint8* put_u32(Uint8* p, Uint32 v);
+Uint16 get_u16(const Uint8* p);
+Uint32 get_u32(const Uint8* p);
+
+#endif
+
+/* EOF */
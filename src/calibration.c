@@ -0,0 +1,244 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "calibration.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+// Safety margins on top of what was measured, the inner deadzone is
+// the resting noise times INNER_MARGIN, the outer one is widened by
+// OUTER_MARGIN units
+#define INNER_MARGIN 1.25
+#define OUTER_MARGIN 1024
+
+// Resting noise below this many standard deviations is covered by the
+// inner deadzone even when the samples never got that far
+#define INNER_SIGMAS 4.0
+
+// A sweep has to cover at least half of the range of an axis to be
+// used for the outer deadzone
+#define SWEEP_MIN_RANGE 32768
+
+typedef struct
+{
+  int offset;
+  int inner;
+  int outer;  // -1 when the axis wasn't swept
+} Deadzones;
+
+static Deadzones recommend(const AxisStats* rest, const AxisStats* sweep)
+{
+  Deadzones dz;
+
+  double noise = SDL_max(SDL_max(rest->max - rest->mean, rest->mean - rest->min),
+                         INNER_SIGMAS * axis_stats_stddev(rest));
+  dz.offset = (int)lround(rest->mean);
+  dz.inner = SDL_min((int)ceil(noise * INNER_MARGIN), 32767);
+
+  if (sweep->count == 0 || sweep->max - sweep->min < SWEEP_MIN_RANGE)
+  {
+    dz.outer = -1;
+  }
+  else
+  {
+    // the part of the range the stick couldn't reach on its weaker side
+    int shortfall = SDL_max(32767 - sweep->max, sweep->min + 32768);
+    dz.outer = SDL_min(shortfall + OUTER_MARGIN, 32767);
+  }
+
+  return dz;
+}
+
+static double percent(int value)
+{
+  return value * 100.0 / 32767.0;
+}
+
+static void print_json_str(FILE* out, const char* str)
+{
+  fputc('"', out);
+  for(const unsigned char* p = (const unsigned char*)str; *p; ++p)
+  {
+    if (*p == '"' || *p == '\\')
+    {
+      fprintf(out, "\\%c", *p);
+    }
+    else if (*p < 0x20)
+    {
+      fprintf(out, "\\u%04x", *p);
+    }
+    else
+    {
+      fputc(*p, out);
+    }
+  }
+  fputc('"', out);
+}
+
+void axis_stats_init(AxisStats* stats)
+{
+  stats->count = 0;
+  stats->mean = 0.0;
+  stats->m2 = 0.0;
+  stats->min = 0;
+  stats->max = 0;
+}
+
+void axis_stats_add(AxisStats* stats, int value)
+{
+  stats->count += 1;
+
+  double delta = value - stats->mean;
+  stats->mean += delta / (double)stats->count;
+  stats->m2 += delta * (value - stats->mean);
+
+  if (stats->count == 1)
+  {
+    stats->min = value;
+    stats->max = value;
+  }
+  else
+  {
+    stats->min = SDL_min(stats->min, value);
+    stats->max = SDL_max(stats->max, value);
+  }
+}
+
+double axis_stats_stddev(const AxisStats* stats)
+{
+  if (stats->count < 2)
+  {
+    return 0.0;
+  }
+  else
+  {
+    return sqrt(stats->m2 / (double)(stats->count - 1));
+  }
+}
+
+void calibration_init(Calibration* cal, int num_axes)
+{
+  cal->num_axes = num_axes;
+  cal->rest  = calloc((size_t)num_axes, sizeof(AxisStats));
+  cal->sweep = calloc((size_t)num_axes, sizeof(AxisStats));
+
+  for(int i = 0; i < num_axes; ++i)
+  {
+    axis_stats_init(&cal->rest[i]);
+    axis_stats_init(&cal->sweep[i]);
+  }
+}
+
+void calibration_free(Calibration* cal)
+{
+  free(cal->rest);
+  free(cal->sweep);
+  cal->rest = NULL;
+  cal->sweep = NULL;
+  cal->num_axes = 0;
+}
+
+void calibration_add(Calibration* cal, CalibrationPhase phase, int axis, int value)
+{
+  if (axis >= 0 && axis < cal->num_axes)
+  {
+    axis_stats_add(phase == CALIBRATION_REST ? &cal->rest[axis] : &cal->sweep[axis], value);
+  }
+}
+
+void calibration_print(const Calibration* cal, int joy_idx, const char* name,
+                       OutputFormat format, int header, FILE* out)
+{
+  switch(format)
+  {
+    case OUTPUT_TEXT:
+      fprintf(out, "Calibration of joystick %d '%s':\n", joy_idx, name);
+      fprintf(out, "  Axis  Samples     Mean  Stddev   Rest min/max  Sweep min/max  Offset"
+                   "  Inner deadzone  Outer deadzone\n");
+      break;
+
+    case OUTPUT_CSV:
+      if (header)
+      {
+        fprintf(out, "joystick,axis,samples,mean,stddev,min,max,sweep_samples,sweep_min,sweep_max,"
+                     "offset,inner_deadzone,outer_deadzone\n");
+      }
+      break;
+
+    case OUTPUT_JSONL:
+      break;
+  }
+
+  for(int i = 0; i < cal->num_axes; ++i)
+  {
+    const AxisStats* rest = &cal->rest[i];
+    const AxisStats* sweep = &cal->sweep[i];
+    Deadzones dz = recommend(rest, sweep);
+    double stddev = axis_stats_stddev(rest);
+
+    switch(format)
+    {
+      case OUTPUT_TEXT:
+        fprintf(out, "  %4d  %7lu  %7.1f  %6.1f  %6d %6d  ",
+                i, rest->count, rest->mean, stddev, rest->min, rest->max);
+        if (sweep->count)
+        {
+          fprintf(out, "%6d %6d  ", sweep->min, sweep->max);
+        }
+        else
+        {
+          fprintf(out, "%13s  ", "-");
+        }
+        fprintf(out, "%6d  %6d (%4.1f%%)", dz.offset, dz.inner, percent(dz.inner));
+        if (dz.outer < 0)
+        {
+          fprintf(out, "  not swept\n");
+        }
+        else
+        {
+          fprintf(out, "  %6d (%4.1f%%)\n", dz.outer, percent(dz.outer));
+        }
+        break;
+
+      case OUTPUT_CSV:
+        fprintf(out, "%d,%d,%lu,%.2f,%.2f,%d,%d,%lu,%d,%d,%d,%d,%d\n",
+                joy_idx, i, rest->count, rest->mean, stddev, rest->min, rest->max,
+                sweep->count, sweep->min, sweep->max, dz.offset, dz.inner, dz.outer);
+        break;
+
+      case OUTPUT_JSONL:
+        fprintf(out, "{\"joystick\":%d,\"name\":", joy_idx);
+        print_json_str(out, name);
+        fprintf(out, ",\"axis\":%d,\"samples\":%lu,\"mean\":%.2f,\"stddev\":%.2f,\"min\":%d,\"max\":%d,"
+                     "\"sweep_samples\":%lu,\"sweep_min\":%d,\"sweep_max\":%d,"
+                     "\"offset\":%d,\"inner_deadzone\":%d,",
+                i, rest->count, rest->mean, stddev, rest->min, rest->max,
+                sweep->count, sweep->min, sweep->max, dz.offset, dz.inner);
+        if (dz.outer < 0)
+        {
+          fprintf(out, "\"outer_deadzone\":null}\n");
+        }
+        else
+        {
+          fprintf(out, "\"outer_deadzone\":%d}\n", dz.outer);
+        }
+        break;
+    }
+  }
+}
+
+/* EOF */
@@ -0,0 +1,67 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_CALIBRATION_H
+#define HEADER_SDL_JSTEST_CALIBRATION_H
+
+#include <stdio.h>
+
+#include "output.h"
+
+// Running mean and variance of the values of an axis, updated one
+// sample at a time with Welford's algorithm, so nothing but these
+// fields has to be kept around no matter how long the run is
+typedef struct
+{
+  unsigned long count;
+  double mean;
+  double m2;
+  int min;
+  int max;
+} AxisStats;
+
+void axis_stats_init(AxisStats* stats);
+void axis_stats_add(AxisStats* stats, int value);
+double axis_stats_stddev(const AxisStats* stats);
+
+typedef enum
+{
+  CALIBRATION_REST,  // the joystick isn't touched
+  CALIBRATION_SWEEP  // every axis is moved to both ends
+} CalibrationPhase;
+
+// The samples of --calibrate of a single joystick
+typedef struct
+{
+  int num_axes;
+  AxisStats* rest;
+  AxisStats* sweep;
+} Calibration;
+
+void calibration_init(Calibration* cal, int num_axes);
+void calibration_free(Calibration* cal);
+
+void calibration_add(Calibration* cal, CalibrationPhase phase, int axis, int value);
+
+// Print the statistics and the recommended deadzones of every axis.
+// The csv header is only printed when header is set, so the rows of
+// several joysticks can follow each other.
+void calibration_print(const Calibration* cal, int joy_idx, const char* name,
+                       OutputFormat format, int header, FILE* out);
+
+#endif
+
+/* EOF */
@@ -0,0 +1,56 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "event_ingest.h"
+
+#include <stdio.h>
+
+int event_ingest(EventIngest* ingest, const SDL_Event* event)
+{
+  if (ingest->recorder)
+  {
+    recorder_add(ingest->recorder, event);
+  }
+
+  JoystickState* state = joystick_state_list_find(ingest->list, joystick_event_which(event));
+  if (state)
+  {
+    rate_estimator_add(&state->rate, event->common.timestamp);
+    joystick_state_handle_event(state, event);
+  }
+
+  if (ingest->latency)
+  {
+    latency_stats_add(ingest->latency, event, SDL_GetTicks());
+  }
+
+  if (event->type == SDL_QUIT)
+  {
+    if (ingest->output)
+    {
+      output_message(ingest->output, "Recieved interrupt, exiting\n");
+    }
+    return 1;
+  }
+  else if (ingest->output && !output_event(ingest->output, event))
+  {
+    fprintf(stderr, "Error: Unhandled event type: %d\n", event->type);
+  }
+
+  return 0;
+}
+
+/* EOF */
@@ -0,0 +1,43 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_EVENT_INGEST_H
+#define HEADER_SDL_JSTEST_EVENT_INGEST_H
+
+#include <SDL.h>
+
+#include "joystick_state.h"
+#include "latency.h"
+#include "output.h"
+#include "recorder.h"
+
+// What --event does with every event, shared with the ingest
+// benchmark so that it measures the real thing
+typedef struct
+{
+  const JoystickStateList* list;  // joysticks whose state is kept
+  Recorder* recorder;             // NULL when not recording
+  LatencyStats* latency;          // NULL when not measuring
+  Output* output;                 // NULL when the events aren't printed
+} EventIngest;
+
+// Record the event, update the state of its joystick and measure or
+// print it, returns 1 on SDL_QUIT
+int event_ingest(EventIngest* ingest, const SDL_Event* event);
+
+#endif
+
+/* EOF */
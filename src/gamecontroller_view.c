@@ -0,0 +1,258 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gamecontroller_view.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Lines of the sections, the label of each section is on the line
+// above it
+#define AXES_Y 3
+
+// Width of the value column of an axis, as laid out by " %6d  ["
+#define AXIS_VALUE_WIDTH 9
+
+static int view_print(GameControllerView* view, WINDOW* win, int y, int x, const char* fmt, ...)
+{
+  if (y >= view->height)
+  {
+    return 0;
+  }
+  else
+  {
+    char buf[256];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+
+    mvwaddstr(win, y, x, buf);
+    return 1;
+  }
+}
+
+static void read_state(GameControllerView* view)
+{
+  for(int i = 0; i < SDL_CONTROLLER_AXIS_MAX; ++i)
+  {
+    view->axes[i] = SDL_GameControllerGetAxis(view->gamepad, (SDL_GameControllerAxis)i);
+  }
+
+  for(int i = 0; i < SDL_CONTROLLER_BUTTON_MAX; ++i)
+  {
+    view->buttons[i] = SDL_GameControllerGetButton(view->gamepad, (SDL_GameControllerButton)i);
+  }
+}
+
+static void draw_header(GameControllerView* view, WINDOW* win)
+{
+  wmove(win, 0, 0);
+  wclrtoeol(win);
+  view_print(view, win, 0, 0, "Gamecontroller Number: %d  %s%s", view->idx, view->name,
+             view->connected ? "" : "  (disconnected)");
+  view->shown_connected = view->connected;
+}
+
+static void draw_axis(GameControllerView* view, WINDOW* win, int i)
+{
+  if (view_print(view, win, AXES_Y + i, 0, "  %-*s %6d  ",
+                 view->name_len, view->axis_names[i], view->axes[i]))
+  {
+    widget_bar(win, &view->widgets, view->axes[i]);
+  }
+  view->shown_axes[i] = view->axes[i];
+}
+
+static void draw_button(GameControllerView* view, WINDOW* win, int i)
+{
+  int cell_width = view->name_len + 4;
+  view_print(view, win,
+             view->buttons_y + i / view->button_columns,
+             2 + (i % view->button_columns) * cell_width,
+             "%*s[%c]", view->name_len, view->button_names[i], view->buttons[i] ? '#' : ' ');
+  view->shown_buttons[i] = view->buttons[i];
+}
+
+static void draw_all(GameControllerView* view, WINDOW* win)
+{
+  view->width = getmaxx(win);
+  view->height = getmaxy(win);
+
+  int bar_x = 2 + view->name_len + AXIS_VALUE_WIDTH;
+  widgets_resize(&view->widgets, SDL_max(view->width - bar_x - 2, 3));
+
+  view->button_columns = SDL_max((view->width - 2) / (view->name_len + 4), 1);
+  view->buttons_y = AXES_Y + SDL_CONTROLLER_AXIS_MAX + 2;
+
+  werase(win);
+  draw_header(view, win);
+
+  view_print(view, win, AXES_Y - 1, 0, "Axes %2d:", SDL_CONTROLLER_AXIS_MAX);
+  for(int i = 0; i < SDL_CONTROLLER_AXIS_MAX; ++i)
+  {
+    draw_axis(view, win, i);
+  }
+
+  view_print(view, win, view->buttons_y - 1, 0, "Buttons %2d:", SDL_CONTROLLER_BUTTON_MAX);
+  for(int i = 0; i < SDL_CONTROLLER_BUTTON_MAX; ++i)
+  {
+    draw_button(view, win, i);
+  }
+
+  view->valid = 1;
+}
+
+static void draw_changes(GameControllerView* view, WINDOW* win)
+{
+  if (view->shown_connected != view->connected)
+  {
+    draw_header(view, win);
+  }
+
+  for(int i = 0; i < SDL_CONTROLLER_AXIS_MAX; ++i)
+  {
+    if (view->shown_axes[i] != view->axes[i])
+    {
+      int old_pos = widget_bar_pos(&view->widgets, view->shown_axes[i]);
+      int new_pos = widget_bar_pos(&view->widgets, view->axes[i]);
+      int y = AXES_Y + i;
+      int x = 2 + view->name_len + 1;
+
+      view_print(view, win, y, x, "%6d", view->axes[i]);
+      if (old_pos != new_pos && y < view->height)
+      {
+        x = 2 + view->name_len + AXIS_VALUE_WIDTH + 1;
+        mvwaddch(win, y, x + old_pos, ' ');
+        mvwaddch(win, y, x + new_pos, '#');
+      }
+      view->shown_axes[i] = view->axes[i];
+    }
+  }
+
+  for(int i = 0; i < SDL_CONTROLLER_BUTTON_MAX; ++i)
+  {
+    if (view->shown_buttons[i] != view->buttons[i])
+    {
+      draw_button(view, win, i);
+    }
+  }
+}
+
+void gamecontroller_view_init(GameControllerView* view, SDL_GameController* gamepad, int idx)
+{
+  memset(view, 0, sizeof(GameControllerView));
+  widgets_init(&view->widgets);
+
+  view->gamepad = gamepad;
+  view->id = SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(gamepad));
+  view->idx = idx;
+  view->connected = 1;
+
+  const char* name = SDL_GameControllerName(gamepad);
+  view->name = SDL_strdup(name ? name : "");
+
+  for(int i = 0; i < SDL_CONTROLLER_AXIS_MAX; ++i)
+  {
+    const char* str = SDL_GameControllerGetStringForAxis((SDL_GameControllerAxis)i);
+    view->axis_names[i] = str ? str : "?";
+    view->name_len = SDL_max(view->name_len, (int)strlen(view->axis_names[i]));
+  }
+
+  for(int i = 0; i < SDL_CONTROLLER_BUTTON_MAX; ++i)
+  {
+    const char* str = SDL_GameControllerGetStringForButton((SDL_GameControllerButton)i);
+    view->button_names[i] = str ? str : "?";
+    view->name_len = SDL_max(view->name_len, (int)strlen(view->button_names[i]));
+  }
+
+  read_state(view);
+}
+
+void gamecontroller_view_free(GameControllerView* view)
+{
+  widgets_free(&view->widgets);
+  SDL_free(view->name);
+  view->name = NULL;
+}
+
+int gamecontroller_view_handle_event(GameControllerView* view, const SDL_Event* event)
+{
+  switch(event->type)
+  {
+    case SDL_CONTROLLERAXISMOTION:
+      if (event->caxis.which != view->id || event->caxis.axis >= SDL_CONTROLLER_AXIS_MAX)
+      {
+        return 0;
+      }
+      view->axes[event->caxis.axis] = event->caxis.value;
+      return 1;
+
+    case SDL_CONTROLLERBUTTONDOWN:
+    case SDL_CONTROLLERBUTTONUP:
+      if (event->cbutton.which != view->id || event->cbutton.button >= SDL_CONTROLLER_BUTTON_MAX)
+      {
+        return 0;
+      }
+      view->buttons[event->cbutton.button] = event->cbutton.state;
+      return 1;
+
+    case SDL_CONTROLLERDEVICEREMAPPED:
+      if (event->cdevice.which != view->id)
+      {
+        return 0;
+      }
+      // a new mapping can move everything around, this is the only
+      // time the whole state is read back from SDL
+      read_state(view);
+      return 1;
+
+    case SDL_CONTROLLERDEVICEREMOVED:
+      if (event->cdevice.which != view->id)
+      {
+        return 0;
+      }
+      view->connected = 0;
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+void gamecontroller_view_invalidate(GameControllerView* view)
+{
+  view->valid = 0;
+}
+
+void gamecontroller_view_draw(GameControllerView* view, WINDOW* win)
+{
+  if (!view->valid ||
+      view->width != getmaxx(win) ||
+      view->height != getmaxy(win))
+  {
+    draw_all(view, win);
+  }
+  else
+  {
+    draw_changes(view, win);
+  }
+}
+
+/* EOF */
@@ -0,0 +1,73 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_GAMECONTROLLER_VIEW_H
+#define HEADER_SDL_JSTEST_GAMECONTROLLER_VIEW_H
+
+#include <SDL.h>
+#include <curses.h>
+
+#include "widgets.h"
+
+// The --gamecontroller view. The state of the controller is kept up to
+// date from SDL_CONTROLLER* events instead of asking SDL for every
+// button and axis, and only the fields that changed since the last
+// frame are redrawn. The names of the buttons and axes are looked up
+// once when the view is created.
+typedef struct
+{
+  SDL_GameController* gamepad;
+  SDL_JoystickID id;
+  int idx;
+  char* name;
+
+  const char* axis_names[SDL_CONTROLLER_AXIS_MAX];
+  const char* button_names[SDL_CONTROLLER_BUTTON_MAX];
+  int name_len;  // longest button or axis name
+
+  // current state, as received from events
+  Sint16 axes[SDL_CONTROLLER_AXIS_MAX];
+  Uint8  buttons[SDL_CONTROLLER_BUTTON_MAX];
+  int connected;
+
+  // what is on screen
+  int valid;
+  int width;
+  int height;
+  Widgets widgets;
+  Sint16 shown_axes[SDL_CONTROLLER_AXIS_MAX];
+  Uint8  shown_buttons[SDL_CONTROLLER_BUTTON_MAX];
+  int shown_connected;
+  int button_columns;
+  int buttons_y;
+} GameControllerView;
+
+// gamepad stays owned by the caller
+void gamecontroller_view_init(GameControllerView* view, SDL_GameController* gamepad, int idx);
+void gamecontroller_view_free(GameControllerView* view);
+
+// Update the state from an event, returns 1 when the event belonged
+// to the controller of the view
+int gamecontroller_view_handle_event(GameControllerView* view, const SDL_Event* event);
+
+// Forget what is on screen, e.g. after clear()
+void gamecontroller_view_invalidate(GameControllerView* view);
+
+void gamecontroller_view_draw(GameControllerView* view, WINDOW* win);
+
+#endif
+
+/* EOF */
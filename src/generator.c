@@ -0,0 +1,507 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "generator.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#include "joystick_state.h"
+
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+
+#ifndef M_PI
+#  define M_PI 3.14159265358979323846
+#endif
+
+#define MAX_RATE    100000
+#define MAX_COUNT   16
+#define MAX_AXES    64
+#define MAX_BUTTONS 256
+#define MAX_HATS    16
+
+// Largest change of a random walk axis per update
+#define WALK_STEP 512
+
+typedef enum
+{
+  WAVE_SINE,
+  WAVE_SQUARE,
+  WAVE_WALK,
+  WAVE_STORM
+} Wave;
+
+typedef struct
+{
+  int device_index;
+  SDL_JoystickID instance_id;
+  SDL_Joystick* joy;
+
+  // what was last set, so only changes are passed to SDL
+  Sint16* axes;
+  Uint8*  buttons;
+  Uint8*  hats;
+
+  Uint32 random;
+} VirtualDevice;
+
+struct Generator
+{
+  int count;
+  int num_axes;
+  int num_buttons;
+  int num_hats;
+  int rate;
+  Wave wave;
+  double hz;
+
+  VirtualDevice* devices;
+
+  SDL_Thread* thread;
+  SDL_atomic_t quit;
+
+  // only touched by the thread until it is joined
+  Uint64 start_counter;
+  Uint64 end_counter;
+  Uint64 updates;
+  Uint64 changes;
+  Uint64 skipped;
+};
+
+static const Uint8 hat_directions[8] = {
+  SDL_HAT_UP, SDL_HAT_RIGHTUP, SDL_HAT_RIGHT, SDL_HAT_RIGHTDOWN,
+  SDL_HAT_DOWN, SDL_HAT_LEFTDOWN, SDL_HAT_LEFT, SDL_HAT_LEFTUP
+};
+
+static Uint32 xorshift(Uint32* state)
+{
+  Uint32 x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+static int parse_int(const char* value, int min, int max, int* out)
+{
+  char* endptr;
+  long tmp = strtol(value, &endptr, 10);
+  if (endptr == value || *endptr != '\0' || tmp < min || tmp > max)
+  {
+    return 0;
+  }
+  *out = (int)tmp;
+  return 1;
+}
+
+static int parse_spec(Generator* gen, const char* spec)
+{
+  char* copy = SDL_strdup(spec);
+  char* next = copy;
+  int ok = 1;
+
+  while (ok && next)
+  {
+    char* item = next;
+    next = strchr(item, ',');
+    if (next)
+    {
+      *next++ = '\0';
+    }
+
+    char* value = strchr(item, '=');
+    if (!value)
+    {
+      fprintf(stderr, "error: --virtual: expected key=value, got '%s'\n", item);
+      ok = 0;
+      break;
+    }
+    *value++ = '\0';
+
+    if (strcmp(item, "count") == 0)
+    {
+      ok = parse_int(value, 1, MAX_COUNT, &gen->count);
+    }
+    else if (strcmp(item, "axes") == 0)
+    {
+      ok = parse_int(value, 0, MAX_AXES, &gen->num_axes);
+    }
+    else if (strcmp(item, "buttons") == 0)
+    {
+      ok = parse_int(value, 0, MAX_BUTTONS, &gen->num_buttons);
+    }
+    else if (strcmp(item, "hats") == 0)
+    {
+      ok = parse_int(value, 0, MAX_HATS, &gen->num_hats);
+    }
+    else if (strcmp(item, "rate") == 0)
+    {
+      ok = parse_int(value, 1, MAX_RATE, &gen->rate);
+    }
+    else if (strcmp(item, "hz") == 0)
+    {
+      char* endptr;
+      gen->hz = strtod(value, &endptr);
+      ok = endptr != value && *endptr == '\0' && gen->hz > 0.0;
+    }
+    else if (strcmp(item, "wave") == 0)
+    {
+      if (strcmp(value, "sine") == 0)
+      {
+        gen->wave = WAVE_SINE;
+      }
+      else if (strcmp(value, "square") == 0)
+      {
+        gen->wave = WAVE_SQUARE;
+      }
+      else if (strcmp(value, "walk") == 0)
+      {
+        gen->wave = WAVE_WALK;
+      }
+      else if (strcmp(value, "storm") == 0)
+      {
+        gen->wave = WAVE_STORM;
+      }
+      else
+      {
+        ok = 0;
+      }
+    }
+    else
+    {
+      fprintf(stderr, "error: --virtual: unknown key '%s'\n", item);
+      ok = 0;
+      break;
+    }
+
+    if (!ok)
+    {
+      fprintf(stderr, "error: --virtual: invalid value '%s' for '%s'\n", value, item);
+    }
+  }
+
+  SDL_free(copy);
+  return ok;
+}
+
+// Position of a wave at time t with its phase shifted by phase periods
+static double wave_value(const Generator* gen, double t, double phase)
+{
+  double s = sin(2.0 * M_PI * (gen->hz * t + phase));
+  if (gen->wave == WAVE_SQUARE)
+  {
+    return s >= 0.0 ? 1.0 : -1.0;
+  }
+  else
+  {
+    return s;
+  }
+}
+
+static void set_axis(Generator* gen, VirtualDevice* dev, int i, Sint16 value)
+{
+  if (dev->axes[i] != value)
+  {
+    SDL_JoystickSetVirtualAxis(dev->joy, i, value);
+    dev->axes[i] = value;
+    gen->changes += 1;
+  }
+}
+
+static void set_button(Generator* gen, VirtualDevice* dev, int i, Uint8 value)
+{
+  if (dev->buttons[i] != value)
+  {
+    SDL_JoystickSetVirtualButton(dev->joy, i, value);
+    dev->buttons[i] = value;
+    gen->changes += 1;
+  }
+}
+
+static void set_hat(Generator* gen, VirtualDevice* dev, int i, Uint8 value)
+{
+  if (dev->hats[i] != value)
+  {
+    SDL_JoystickSetVirtualHat(dev->joy, i, value);
+    dev->hats[i] = value;
+    gen->changes += 1;
+  }
+}
+
+static void generator_update(Generator* gen, Uint64 step)
+{
+  double t = (double)step / gen->rate;
+
+  for(int d = 0; d < gen->count; ++d)
+  {
+    VirtualDevice* dev = &gen->devices[d];
+
+    for(int i = 0; i < gen->num_axes; ++i)
+    {
+      switch(gen->wave)
+      {
+        case WAVE_SINE:
+        case WAVE_SQUARE:
+          set_axis(gen, dev, i, (Sint16)(32767.0 * wave_value(gen, t, (double)i / gen->num_axes)));
+          break;
+
+        case WAVE_WALK:
+          {
+            int value = dev->axes[i] + (int)(xorshift(&dev->random) % (2 * WALK_STEP + 1)) - WALK_STEP;
+            set_axis(gen, dev, i, (Sint16)SDL_max(SDL_min(value, 32767), -32768));
+          }
+          break;
+
+        case WAVE_STORM:
+          break;
+      }
+    }
+
+    for(int i = 0; i < gen->num_buttons; ++i)
+    {
+      switch(gen->wave)
+      {
+        case WAVE_SINE:
+        case WAVE_SQUARE:
+          set_button(gen, dev, i, wave_value(gen, t, (double)i / gen->num_buttons) > 0.0);
+          break;
+
+        case WAVE_WALK:
+          if (xorshift(&dev->random) % 64 == 0)
+          {
+            set_button(gen, dev, i, !dev->buttons[i]);
+          }
+          break;
+
+        case WAVE_STORM:
+          set_button(gen, dev, i, !dev->buttons[i]);
+          break;
+      }
+    }
+
+    for(int i = 0; i < gen->num_hats; ++i)
+    {
+      Uint64 direction = gen->wave == WAVE_STORM ? gen->updates : (Uint64)(gen->hz * t * 8.0);
+      set_hat(gen, dev, i, hat_directions[(direction + (Uint64)i) % 8]);
+    }
+  }
+
+  gen->updates += 1;
+}
+
+static int generator_thread(void* userdata)
+{
+  Generator* gen = userdata;
+  Uint64 freq = SDL_GetPerformanceFrequency();
+  Uint64 step = 0;
+
+  gen->start_counter = SDL_GetPerformanceCounter();
+  while (!SDL_AtomicGet(&gen->quit))
+  {
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 due = (Uint64)((double)(now - gen->start_counter) * gen->rate / (double)freq);
+
+    if (due > step)
+    {
+      // updates that are already overdue would only be overwritten
+      // before SDL sees them, so only the latest one is applied
+      gen->skipped += due - step - 1;
+      generator_update(gen, due - 1);
+      step = due;
+    }
+    else
+    {
+      // sleep when the next update is further away than the sleep
+      // granularity, otherwise yield and look again
+      double wait_ms = ((double)step * (double)freq / gen->rate - (double)(now - gen->start_counter)) *
+        1000.0 / (double)freq;
+      SDL_Delay(wait_ms > 2.0 ? 1 : 0);
+    }
+  }
+  gen->end_counter = SDL_GetPerformanceCounter();
+
+  return 0;
+}
+
+Generator* generator_open(const char* spec)
+{
+  Generator* gen = calloc(1, sizeof(Generator));
+  gen->count = 1;
+  gen->num_axes = 6;
+  gen->num_buttons = 16;
+  gen->num_hats = 1;
+  gen->rate = 1000;
+  gen->wave = WAVE_SINE;
+  gen->hz = 1.0;
+
+  if (!parse_spec(gen, spec))
+  {
+    free(gen);
+    return NULL;
+  }
+
+  gen->devices = calloc((size_t)gen->count, sizeof(VirtualDevice));
+  for(int d = 0; d < gen->count; ++d)
+  {
+    gen->devices[d].device_index = -1;
+  }
+
+  for(int d = 0; d < gen->count; ++d)
+  {
+    VirtualDevice* dev = &gen->devices[d];
+    char name[64];
+    snprintf(name, sizeof(name), "sdl2-jstest virtual joystick %d", d);
+
+    SDL_VirtualJoystickDesc desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.version = SDL_VIRTUAL_JOYSTICK_DESC_VERSION;
+    desc.type = SDL_JOYSTICK_TYPE_UNKNOWN;
+    desc.naxes = (Uint16)gen->num_axes;
+    desc.nbuttons = (Uint16)gen->num_buttons;
+    desc.nhats = (Uint16)gen->num_hats;
+    desc.name = name;
+
+    dev->axes    = calloc((size_t)gen->num_axes + 1,    sizeof(Sint16));
+    dev->buttons = calloc((size_t)gen->num_buttons + 1, sizeof(Uint8));
+    dev->hats    = calloc((size_t)gen->num_hats + 1,    sizeof(Uint8));
+    dev->random  = 2463534242u + (Uint32)d;
+
+    dev->device_index = SDL_JoystickAttachVirtualEx(&desc);
+    if (dev->device_index < 0)
+    {
+      fprintf(stderr, "error: couldn't attach virtual joystick: %s\n", SDL_GetError());
+      generator_close(gen);
+      return NULL;
+    }
+    dev->instance_id = SDL_JoystickGetDeviceInstanceID(dev->device_index);
+
+    // the generator keeps its own handle, the virtual joystick can
+    // only be fed through one
+    dev->joy = SDL_JoystickOpen(dev->device_index);
+    if (!dev->joy)
+    {
+      fprintf(stderr, "error: couldn't open virtual joystick: %s\n", SDL_GetError());
+      generator_close(gen);
+      return NULL;
+    }
+  }
+
+  SDL_AtomicSet(&gen->quit, 0);
+  gen->thread = SDL_CreateThread(generator_thread, "generator", gen);
+  if (!gen->thread)
+  {
+    fprintf(stderr, "error: couldn't create generator thread: %s\n", SDL_GetError());
+    generator_close(gen);
+    return NULL;
+  }
+
+  fprintf(stderr, "Generating %d updates/s on %d virtual joystick%s with %d axes, %d buttons and %d hats,"
+          " starting at joystick %d\n",
+          gen->rate, gen->count, gen->count == 1 ? "" : "s",
+          gen->num_axes, gen->num_buttons, gen->num_hats, gen->devices[0].device_index);
+
+  return gen;
+}
+
+int generator_count(const Generator* gen)
+{
+  return gen->count;
+}
+
+int generator_device_index(const Generator* gen, int i)
+{
+  return gen->devices[i].device_index;
+}
+
+void generator_close(Generator* gen)
+{
+  if (gen->thread)
+  {
+    SDL_AtomicSet(&gen->quit, 1);
+    SDL_WaitThread(gen->thread, NULL);
+
+    double seconds = (double)(gen->end_counter - gen->start_counter) / (double)SDL_GetPerformanceFrequency();
+    fprintf(stderr, "Generated %llu updates with %llu changes in %.3f s (%.0f changes/s)\n",
+            (unsigned long long)gen->updates, (unsigned long long)gen->changes, seconds,
+            seconds > 0.0 ? (double)gen->changes / seconds : 0.0);
+    if (gen->skipped)
+    {
+      fprintf(stderr, "Skipped %llu updates, the generator thread fell behind\n",
+              (unsigned long long)gen->skipped);
+    }
+  }
+
+  for(int d = 0; d < gen->count; ++d)
+  {
+    VirtualDevice* dev = &gen->devices[d];
+    if (dev->joy)
+    {
+      SDL_JoystickClose(dev->joy);
+    }
+    if (dev->device_index >= 0)
+    {
+      // every detach and every joystick unplugged in the meantime
+      // shifts the indices, so look it up again
+      int device_index = joystick_device_index(dev->instance_id);
+      if (device_index >= 0)
+      {
+        SDL_JoystickDetachVirtual(device_index);
+      }
+    }
+    free(dev->hats);
+    free(dev->buttons);
+    free(dev->axes);
+  }
+
+  free(gen->devices);
+  free(gen);
+}
+
+#else
+
+struct Generator
+{
+  int count;
+};
+
+Generator* generator_open(const char* spec)
+{
+  fprintf(stderr, "error: --virtual requires SDL 2.24.0 or newer\n");
+  return NULL;
+}
+
+int generator_count(const Generator* gen)
+{
+  return gen->count;
+}
+
+int generator_device_index(const Generator* gen, int i)
+{
+  return -1;
+}
+
+void generator_close(Generator* gen)
+{
+}
+
+#endif
+
+/* EOF */
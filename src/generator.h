@@ -0,0 +1,59 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_GENERATOR_H
+#define HEADER_SDL_JSTEST_GENERATOR_H
+
+// Drives SDL virtual joysticks from a timer thread with scripted
+// waveforms, as a controllable event source for measuring how many
+// events per second the other modes keep up with.
+//
+// The devices are described by a SPEC of comma separated key=value
+// pairs, every key is optional:
+//
+//   count=N     number of virtual joysticks (1)
+//   axes=N      axes of each joystick (6)
+//   buttons=N   buttons of each joystick (16)
+//   hats=N      hats of each joystick (1)
+//   rate=HZ     updates per second, up to 100000 (1000)
+//   wave=NAME   sine, square, walk or storm (sine)
+//   hz=HZ       frequency of the sine and square waves (1)
+//
+// sine and square move the axes through phase shifted waves and press
+// the buttons and hats while the matching axis is positive, walk moves
+// every axis randomly, storm flips every button on every update.
+//
+// SDL turns the virtual joystick state into events when it pumps
+// events, a control that changes several times between two pumps
+// results in a single event. The difference between the changes
+// generated and the events a mode receives is what it missed.
+typedef struct Generator Generator;
+
+// Attach the virtual joysticks and start the timer thread, returns
+// NULL on error
+Generator* generator_open(const char* spec);
+
+// Number of virtual joysticks and the device index of joystick i
+int generator_count(const Generator* gen);
+int generator_device_index(const Generator* gen, int i);
+
+// Stop the thread, detach the joysticks and print how many updates
+// and changes were generated
+void generator_close(Generator* gen);
+
+#endif
+
+/* EOF */
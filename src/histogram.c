@@ -0,0 +1,107 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "histogram.h"
+
+#include <string.h>
+
+static int highest_bit(uint32_t value)
+{
+  int bit = 0;
+  while (value >>= 1)
+  {
+    bit += 1;
+  }
+  return bit;
+}
+
+static int bucket_index(uint32_t value)
+{
+  if (value < HISTOGRAM_SUB_COUNT)
+  {
+    return (int)value;
+  }
+  else
+  {
+    int shift = highest_bit(value) - HISTOGRAM_SUB_BITS;
+    return (shift + 1) * HISTOGRAM_SUB_COUNT + (int)(value >> shift) - HISTOGRAM_SUB_COUNT;
+  }
+}
+
+// Largest value that still lands in bucket idx
+static uint32_t bucket_upper_bound(int idx)
+{
+  if (idx < HISTOGRAM_SUB_COUNT)
+  {
+    return (uint32_t)idx;
+  }
+  else
+  {
+    int shift = idx / HISTOGRAM_SUB_COUNT - 1;
+    uint32_t sub = (uint32_t)(idx % HISTOGRAM_SUB_COUNT + HISTOGRAM_SUB_COUNT);
+    return (sub << shift) + ((1u << shift) - 1u);
+  }
+}
+
+void histogram_init(Histogram* hist)
+{
+  memset(hist, 0, sizeof(*hist));
+  hist->min = UINT32_MAX;
+}
+
+void histogram_add(Histogram* hist, uint32_t value)
+{
+  hist->count += 1;
+  hist->sum += value;
+  if (value < hist->min) hist->min = value;
+  if (value > hist->max) hist->max = value;
+  hist->buckets[bucket_index(value)] += 1;
+}
+
+uint32_t histogram_percentile(const Histogram* hist, double percent)
+{
+  if (hist->count == 0)
+  {
+    return 0;
+  }
+  else
+  {
+    uint64_t rank = (uint64_t)((double)hist->count * percent / 100.0 + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > hist->count) rank = hist->count;
+
+    uint64_t seen = 0;
+    for(int i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    {
+      seen += hist->buckets[i];
+      if (seen >= rank)
+      {
+        uint32_t value = bucket_upper_bound(i);
+        if (value < hist->min) value = hist->min;
+        if (value > hist->max) value = hist->max;
+        return value;
+      }
+    }
+    return hist->max;
+  }
+}
+
+double histogram_mean(const Histogram* hist)
+{
+  return hist->count ? (double)hist->sum / (double)hist->count : 0.0;
+}
+
+/* EOF */
@@ -0,0 +1,50 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_HISTOGRAM_H
+#define HEADER_SDL_JSTEST_HISTOGRAM_H
+
+#include <stdint.h>
+
+// Values below 2^HISTOGRAM_SUB_BITS are counted exactly, above that
+// every power of two range is split into 2^HISTOGRAM_SUB_BITS equal
+// buckets, which keeps the relative error below 1/16 for any 32bit
+// value while the memory use stays constant.
+#define HISTOGRAM_SUB_BITS  4
+#define HISTOGRAM_SUB_COUNT (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_BUCKETS   ((32 - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_COUNT)
+
+typedef struct
+{
+  uint64_t count;
+  uint64_t sum;
+  uint32_t min;
+  uint32_t max;
+  uint64_t buckets[HISTOGRAM_BUCKETS];
+} Histogram;
+
+void histogram_init(Histogram* hist);
+void histogram_add(Histogram* hist, uint32_t value);
+
+// Returns the value at or below which the given percentage [0-100] of
+// all samples fall, rounded up to the end of the bucket it lands in
+uint32_t histogram_percentile(const Histogram* hist, double percent);
+
+double histogram_mean(const Histogram* hist);
+
+#endif
+
+/* EOF */
@@ -0,0 +1,405 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "joystick_state.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+JoystickState* joystick_state_open(int joy_idx)
+{
+  SDL_Joystick* joy = SDL_JoystickOpen(joy_idx);
+  if (!joy)
+  {
+    fprintf(stderr, "Unable to open joystick %d\n", joy_idx);
+    return NULL;
+  }
+
+  int num_axes    = SDL_JoystickNumAxes(joy);
+  if (num_axes < 0) {
+    fprintf(stderr, "Unable to get SDL axes count: %s\n", SDL_GetError());
+    SDL_JoystickClose(joy);
+    return NULL;
+  }
+
+  int num_buttons = SDL_JoystickNumButtons(joy);
+  if (num_buttons < 0) {
+    fprintf(stderr, "Unable to get SDL buttons count: %s\n", SDL_GetError());
+    SDL_JoystickClose(joy);
+    return NULL;
+  }
+
+  int num_hats    = SDL_JoystickNumHats(joy);
+  if (num_hats < 0) {
+    fprintf(stderr, "Unable to get SDL hats count: %s\n", SDL_GetError());
+    SDL_JoystickClose(joy);
+    return NULL;
+  }
+
+  int num_balls   = SDL_JoystickNumBalls(joy);
+  if (num_balls < 0) {
+    fprintf(stderr, "Unable to get SDL balls count: %s\n", SDL_GetError());
+    SDL_JoystickClose(joy);
+    return NULL;
+  }
+
+  JoystickState* state = malloc(sizeof(JoystickState));
+  state->joy = joy;
+  state->id = SDL_JoystickInstanceID(joy);
+  state->joy_idx = joy_idx;
+  state->name = SDL_strdup(SDL_JoystickName(joy) ? SDL_JoystickName(joy) : "");
+
+  state->num_axes    = num_axes;
+  state->num_buttons = num_buttons;
+  state->num_hats    = num_hats;
+  state->num_balls   = num_balls;
+
+  state->axes    = calloc((size_t)num_axes,    sizeof(Sint16));
+  state->buttons = calloc((size_t)num_buttons, sizeof(Uint8));
+  state->hats    = calloc((size_t)num_hats,    sizeof(Uint8));
+  state->balls   = calloc((size_t)num_balls,   2*sizeof(Sint16));
+
+  // start from the current values instead of zeros, a freshly plugged
+  // in joystick doesn't send events for controls that are held down
+  // or resting off center. Balls only report relative motion.
+  axis_history_init(&state->history, num_axes);
+  axis_resolution_init(&state->resolution, num_axes);
+  for(int i = 0; i < num_axes; ++i)
+  {
+    state->axes[i] = SDL_JoystickGetAxis(joy, i);
+    axis_history_add(&state->history, i, SDL_GetTicks(), state->axes[i]);
+    axis_resolution_add(&state->resolution, i, state->axes[i]);
+  }
+
+  button_bounce_init(&state->bounce, num_buttons);
+  for(int i = 0; i < num_buttons; ++i)
+  {
+    state->buttons[i] = SDL_JoystickGetButton(joy, i);
+    button_bounce_reset(&state->bounce, i, state->buttons[i], SDL_GetTicks());
+  }
+
+  for(int i = 0; i < num_hats; ++i)
+  {
+    state->hats[i] = SDL_JoystickGetHat(joy, i);
+  }
+
+  rate_estimator_init(&state->rate);
+
+  return state;
+}
+
+void joystick_state_close(JoystickState* state)
+{
+  free(state->balls);
+  free(state->hats);
+  free(state->buttons);
+  free(state->axes);
+  axis_history_free(&state->history);
+  axis_resolution_free(&state->resolution);
+  button_bounce_free(&state->bounce);
+  SDL_free(state->name);
+  if (state->joy)
+  {
+    SDL_JoystickClose(state->joy);
+  }
+  free(state);
+}
+
+int joystick_state_handle_event(JoystickState* state, const SDL_Event* event)
+{
+  switch(event->type)
+  {
+    case SDL_JOYAXISMOTION:
+      if (event->jaxis.axis < state->num_axes)
+      {
+        state->axes[event->jaxis.axis] = event->jaxis.value;
+        axis_history_add(&state->history, event->jaxis.axis,
+                         event->jaxis.timestamp, event->jaxis.value);
+        axis_resolution_add(&state->resolution, event->jaxis.axis, event->jaxis.value);
+        return 1;
+      }
+      break;
+
+    case SDL_JOYBUTTONDOWN:
+    case SDL_JOYBUTTONUP:
+      if (event->jbutton.button < state->num_buttons)
+      {
+        state->buttons[event->jbutton.button] = event->jbutton.state;
+        button_bounce_add(&state->bounce, event->jbutton.button,
+                          event->jbutton.state, event->jbutton.timestamp);
+        return 1;
+      }
+      break;
+
+    case SDL_JOYHATMOTION:
+      if (event->jhat.hat < state->num_hats)
+      {
+        state->hats[event->jhat.hat] = event->jhat.value;
+        return 1;
+      }
+      break;
+
+    case SDL_JOYBALLMOTION:
+      if (event->jball.ball < state->num_balls)
+      {
+        state->balls[2*event->jball.ball + 0] = event->jball.xrel;
+        state->balls[2*event->jball.ball + 1] = event->jball.yrel;
+        return 1;
+      }
+      break;
+  }
+
+  return 0;
+}
+
+SDL_JoystickID joystick_event_which(const SDL_Event* event)
+{
+  switch(event->type)
+  {
+    case SDL_JOYAXISMOTION:
+      return event->jaxis.which;
+
+    case SDL_JOYBALLMOTION:
+      return event->jball.which;
+
+    case SDL_JOYHATMOTION:
+      return event->jhat.which;
+
+    case SDL_JOYBUTTONDOWN:
+    case SDL_JOYBUTTONUP:
+      return event->jbutton.which;
+
+    default:
+      return -1;
+  }
+}
+
+int joystick_device_index(SDL_JoystickID id)
+{
+  int num_joysticks = SDL_NumJoysticks();
+  for(int device_idx = 0; device_idx < num_joysticks; ++device_idx)
+  {
+    if (SDL_JoystickGetDeviceInstanceID(device_idx) == id)
+    {
+      return device_idx;
+    }
+  }
+  return -1;
+}
+
+void joystick_state_list_init(JoystickStateList* list)
+{
+  list->states = NULL;
+  list->count = 0;
+  list->capacity = 0;
+}
+
+void joystick_state_list_free(JoystickStateList* list)
+{
+  for(int i = 0; i < list->count; ++i)
+  {
+    joystick_state_close(list->states[i]);
+  }
+  free(list->states);
+  joystick_state_list_init(list);
+}
+
+void joystick_state_list_add(JoystickStateList* list, JoystickState* state)
+{
+  if (list->count == list->capacity)
+  {
+    list->capacity = list->capacity ? list->capacity * 2 : 4;
+    list->states = realloc(list->states, (size_t)list->capacity * sizeof(JoystickState*));
+  }
+  list->states[list->count++] = state;
+}
+
+void joystick_state_list_remove(JoystickStateList* list, SDL_JoystickID id)
+{
+  for(int i = 0; i < list->count; ++i)
+  {
+    if (list->states[i]->id == id)
+    {
+      joystick_state_close(list->states[i]);
+      list->count -= 1;
+      memmove(list->states + i, list->states + i + 1,
+              (size_t)(list->count - i) * sizeof(JoystickState*));
+      return;
+    }
+  }
+}
+
+JoystickState* joystick_state_list_find(const JoystickStateList* list, SDL_JoystickID id)
+{
+  for(int i = 0; i < list->count; ++i)
+  {
+    if (list->states[i]->id == id)
+    {
+      return list->states[i];
+    }
+  }
+  return NULL;
+}
+
+static JoystickState* joystick_state_clone(const JoystickState* src)
+{
+  JoystickState* state = malloc(sizeof(JoystickState));
+  *state = *src;
+  state->joy = NULL;
+  state->name = SDL_strdup(src->name);
+
+  state->axes    = calloc((size_t)src->num_axes,    sizeof(Sint16));
+  state->buttons = calloc((size_t)src->num_buttons, sizeof(Uint8));
+  state->hats    = calloc((size_t)src->num_hats,    sizeof(Uint8));
+  state->balls   = calloc((size_t)src->num_balls,   2*sizeof(Sint16));
+  axis_history_init(&state->history, src->num_axes);
+  axis_resolution_init(&state->resolution, src->num_axes);
+  button_bounce_init(&state->bounce, src->num_buttons);
+  return state;
+}
+
+void joystick_state_list_copy(JoystickStateList* dst, const JoystickStateList* src)
+{
+  int same = dst->count == src->count;
+  for(int i = 0; same && i < src->count; ++i)
+  {
+    same = dst->states[i]->id == src->states[i]->id;
+  }
+
+  if (!same)
+  {
+    joystick_state_list_free(dst);
+    for(int i = 0; i < src->count; ++i)
+    {
+      joystick_state_list_add(dst, joystick_state_clone(src->states[i]));
+    }
+  }
+
+  for(int i = 0; i < src->count; ++i)
+  {
+    const JoystickState* from = src->states[i];
+    JoystickState* to = dst->states[i];
+
+    memcpy(to->axes,    from->axes,    (size_t)from->num_axes    * sizeof(Sint16));
+    memcpy(to->buttons, from->buttons, (size_t)from->num_buttons * sizeof(Uint8));
+    memcpy(to->hats,    from->hats,    (size_t)from->num_hats    * sizeof(Uint8));
+    memcpy(to->balls,   from->balls,   (size_t)from->num_balls   * 2*sizeof(Sint16));
+    to->rate = from->rate;
+    axis_history_copy(&to->history, &from->history);
+    axis_resolution_copy(&to->resolution, &from->resolution);
+    button_bounce_copy(&to->bounce, &from->bounce);
+  }
+}
+
+int joystick_manager_init(JoystickManager* manager, int joy_idx)
+{
+  joystick_state_list_init(&manager->list);
+  manager->all = joy_idx == JOYSTICK_ALL;
+  memset(&manager->guid, 0, sizeof(manager->guid));
+  manager->connects = 0;
+  manager->disconnects = 0;
+
+  if (manager->all)
+  {
+    for(int i = 0; i < SDL_NumJoysticks(); ++i)
+    {
+      JoystickState* state = joystick_state_open(i);
+      if (state)
+      {
+        joystick_state_list_add(&manager->list, state);
+      }
+    }
+  }
+  else
+  {
+    JoystickState* state = joystick_state_open(joy_idx);
+    if (state)
+    {
+      manager->guid = SDL_JoystickGetGUID(state->joy);
+      joystick_state_list_add(&manager->list, state);
+    }
+  }
+
+  return manager->list.count;
+}
+
+void joystick_manager_free(JoystickManager* manager)
+{
+  joystick_state_list_free(&manager->list);
+}
+
+// SDL sends SDL_JOYDEVICEADDED for the joysticks that were already
+// connected at startup too
+static int joystick_manager_has_device(const JoystickManager* manager, int device_idx)
+{
+  SDL_JoystickID id = SDL_JoystickGetDeviceInstanceID(device_idx);
+  return id >= 0 && joystick_state_list_find(&manager->list, id) != NULL;
+}
+
+int joystick_manager_handle_event(JoystickManager* manager, const SDL_Event* event)
+{
+  switch(event->type)
+  {
+    case SDL_JOYDEVICEADDED:
+      {
+        int device_idx = event->jdevice.which;
+
+        if (!manager->all)
+        {
+          // only pick the tested joystick back up, and only once
+          SDL_JoystickGUID guid = SDL_JoystickGetDeviceGUID(device_idx);
+          if (manager->list.count > 0 ||
+              memcmp(&guid, &manager->guid, sizeof(guid)) != 0)
+          {
+            return 0;
+          }
+        }
+
+        if (joystick_manager_has_device(manager, device_idx))
+        {
+          return 0;
+        }
+
+        JoystickState* state = joystick_state_open(device_idx);
+        if (!state)
+        {
+          return 0;
+        }
+
+        joystick_state_list_add(&manager->list, state);
+        manager->connects += 1;
+        return 1;
+      }
+
+    case SDL_JOYDEVICEREMOVED:
+      if (!joystick_state_list_find(&manager->list, event->jdevice.which))
+      {
+        return 0;
+      }
+      else
+      {
+        joystick_state_list_remove(&manager->list, event->jdevice.which);
+        manager->disconnects += 1;
+        return 1;
+      }
+
+    default:
+      return 0;
+  }
+}
+
+/* EOF */
@@ -0,0 +1,125 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_JOYSTICK_STATE_H
+#define HEADER_SDL_JSTEST_JOYSTICK_STATE_H
+
+#include <SDL.h>
+
+#include "axis_history.h"
+#include "axis_resolution.h"
+#include "button_bounce.h"
+#include "rate_estimator.h"
+
+// Passed instead of a joystick index to --test and --event to use
+// all joysticks at once
+#define JOYSTICK_ALL -1
+
+// The current axis, button, hat and ball values of an open joystick
+// as seen through its events
+typedef struct
+{
+  SDL_Joystick* joy; // NULL in copies made by joystick_state_list_copy()
+  SDL_JoystickID id;
+  int joy_idx;
+  char* name;
+
+  int num_axes;
+  int num_buttons;
+  int num_hats;
+  int num_balls;
+
+  Sint16* axes;
+  Uint8*  buttons;
+  Uint8*  hats;
+  Sint16* balls;
+
+  RateEstimator rate;
+  AxisHistory history;
+  AxisResolution resolution;
+  ButtonBounce bounce;
+} JoystickState;
+
+// Open joystick joy_idx and allocate its state, returns NULL on error
+JoystickState* joystick_state_open(int joy_idx);
+void joystick_state_close(JoystickState* state);
+
+// Apply an axis, button, hat or ball event of this joystick, returns
+// 1 when the event was used
+int joystick_state_handle_event(JoystickState* state, const SDL_Event* event);
+
+// Returns the instance id of the joystick that sent event or -1 when
+// it isn't an input event from a joystick
+SDL_JoystickID joystick_event_which(const SDL_Event* event);
+
+// Returns the current device index of the joystick with that instance
+// id, which changes when a joystick before it is unplugged, or -1 when
+// it is gone
+int joystick_device_index(SDL_JoystickID id);
+
+// The joysticks a mode works with, looked up by instance id
+typedef struct
+{
+  JoystickState** states;
+  int count;
+  int capacity;
+} JoystickStateList;
+
+void joystick_state_list_init(JoystickStateList* list);
+
+// Close all joysticks in the list and free it
+void joystick_state_list_free(JoystickStateList* list);
+
+void joystick_state_list_add(JoystickStateList* list, JoystickState* state);
+
+// Close and drop the joystick with that instance id, the order of the
+// other joysticks is kept
+void joystick_state_list_remove(JoystickStateList* list, SDL_JoystickID id);
+
+// Returns NULL when no joystick with that instance id is in the list
+JoystickState* joystick_state_list_find(const JoystickStateList* list, SDL_JoystickID id);
+
+// Make dst a copy of the values in src that doesn't reference the SDL
+// joysticks, so it can be read by another thread while src keeps
+// changing. The allocations of dst are reused while the joysticks in
+// src stay the same.
+void joystick_state_list_copy(JoystickStateList* dst, const JoystickStateList* src);
+
+// Keeps a JoystickStateList in sync with SDL_JOYDEVICEADDED and
+// SDL_JOYDEVICEREMOVED events. With JOYSTICK_ALL every joystick that
+// gets connected is added, otherwise only the tested joystick is
+// picked up again after it got reconnected, recognized by its GUID.
+typedef struct
+{
+  JoystickStateList list;
+  int all;
+  SDL_JoystickGUID guid;
+
+  unsigned long connects;
+  unsigned long disconnects;
+} JoystickManager;
+
+// Open joystick joy_idx or all joysticks, returns the number opened
+int joystick_manager_init(JoystickManager* manager, int joy_idx);
+void joystick_manager_free(JoystickManager* manager);
+
+// Handle a hotplug event, returns 1 when a joystick was added to or
+// removed from the list
+int joystick_manager_handle_event(JoystickManager* manager, const SDL_Event* event);
+
+#endif
+
+/* EOF */
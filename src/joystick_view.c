@@ -0,0 +1,445 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "joystick_view.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Column of the axis value and of the first cell inside the axis bar,
+// as laid out by "  %2d: %6d  ["
+#define AXIS_VALUE_X  6
+#define AXIS_BAR_X   15
+
+// Buttons are packed into a grid of "%3d[#] " cells
+#define BUTTON_CELL_WIDTH 7
+#define BUTTON_GRID_X     2
+
+// Width of the effective bits column, " %4.1fb"
+#define RESOLUTION_WIDTH 6
+
+// Lines a hat takes up, the value line and the diagram
+#define HAT_LINES (1 + WIDGET_HAT_LINES)
+
+// Window line of a line of the scrolled content or -1 when it is
+// outside of the viewport, line 0 of the window holds the header
+static int view_y(const JoystickView* view, int line)
+{
+  if (line < view->scroll || line >= view->scroll + view->height)
+  {
+    return -1;
+  }
+  else
+  {
+    return line - view->scroll + 1;
+  }
+}
+
+// Print to a line of the content, returns 0 when it isn't visible
+static int view_print(JoystickView* view, WINDOW* win, int line, int x, const char* fmt, ...)
+{
+  int y = view_y(view, line);
+  if (y < 0)
+  {
+    return 0;
+  }
+  else
+  {
+    char buf[JOYSTICK_VIEW_TEXT_MAX];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+
+    mvwaddstr(win, y, x, buf);
+    view->cells += strlen(buf);
+    return 1;
+  }
+}
+
+static void view_cell(JoystickView* view, WINDOW* win, int line, int x, chtype ch)
+{
+  int y = view_y(view, line);
+  if (y >= 0)
+  {
+    mvwaddch(win, y, x, ch);
+    view->cells += 1;
+  }
+}
+
+static void draw_axis(JoystickView* view, WINDOW* win, int i, Sint16 value)
+{
+  if (view_print(view, win, view->axes_y + i, 0, "  %2d: %6d  ", i, value))
+  {
+    view->cells += (unsigned long)widget_bar(win, &view->widgets, value);
+  }
+}
+
+// Redraw the sparkline of axis i when it differs from the one on screen,
+// the time is rounded down to a whole slice so it only scrolls when a
+// slice is complete
+static void draw_spark(JoystickView* view, WINDOW* win, const JoystickState* state, int i, Uint32 now)
+{
+  int y = view_y(view, view->axes_y + i);
+  if (view->spark_width > 0 && y >= 0)
+  {
+    Uint32 slice = SDL_max(JOYSTICK_VIEW_HISTORY_MS / (Uint32)view->spark_width, 1u);
+    char* spark = view->sparks + (size_t)i * (size_t)(view->spark_width + 1);
+    char line[JOYSTICK_VIEW_TEXT_MAX];
+
+    axis_history_sparkline(&state->history, i, now - now % slice, JOYSTICK_VIEW_HISTORY_MS,
+                           line, view->spark_width);
+    if (strcmp(line, spark) != 0)
+    {
+      mvwaddnstr(win, y, AXIS_BAR_X + view->widgets.bar_len + 2, line, view->spark_width);
+      view->cells += (unsigned long)view->spark_width;
+      memcpy(spark, line, (size_t)view->spark_width + 1);
+    }
+  }
+}
+
+// Redraw the effective bits of axis i when it reported new values
+static void draw_resolution(JoystickView* view, WINDOW* win, const JoystickState* state, int i)
+{
+  Uint32 distinct = state->resolution.axes[i].distinct;
+  if (view->resolution_x > 0 && view->resolution_distinct[i] != distinct)
+  {
+    AxisResolutionInfo info;
+    axis_resolution_analyze(&state->resolution, i, &info);
+    if (info.distinct < 2)
+    {
+      view_print(view, win, view->axes_y + i, view->resolution_x, "   - ");
+    }
+    else
+    {
+      view_print(view, win, view->axes_y + i, view->resolution_x, "%4.1fb", info.bits);
+    }
+    view->resolution_distinct[i] = distinct;
+  }
+}
+
+static void draw_button(JoystickView* view, WINDOW* win, const JoystickState* state, int i)
+{
+  int bounced = view->bounce_ms > 0 && button_bounce_count(&state->bounce, i, view->bounce_ms) > 0;
+
+  view_print(view, win,
+             view->buttons_y + i / view->button_columns,
+             BUTTON_GRID_X + (i % view->button_columns) * BUTTON_CELL_WIDTH,
+             "%3d[%c]%c", i, state->buttons[i] ? '#' : ' ', bounced ? '!' : ' ');
+  view->buttons[i] = state->buttons[i];
+  view->button_transitions[i] = state->bounce.buttons[i].transitions;
+}
+
+static void draw_hat(JoystickView* view, WINDOW* win, int i, Uint8 value)
+{
+  int line = view->hats_y + i * HAT_LINES;
+
+  view_print(view, win, line, 0, "  %2d: value: %-3d", i, value);
+  for(int j = 0; j < WIDGET_HAT_LINES; ++j)
+  {
+    int y = view_y(view, line + 1 + j);
+    if (y >= 0)
+    {
+      wmove(win, y, 0);
+      view->cells += (unsigned long)widget_hat_line(win, value, j);
+    }
+  }
+}
+
+static void draw_ball(JoystickView* view, WINDOW* win, int i, const Sint16* value)
+{
+  // the first ball shares its line with the "Balls" label
+  if (i == 0)
+  {
+    view_print(view, win, view->balls_y, 10, "  %2d: %6d %6d", i, value[0], value[1]);
+  }
+  else
+  {
+    view_print(view, win, view->balls_y + i, 0, "  %2d: %6d %6d", i, value[0], value[1]);
+  }
+}
+
+static void free_values(JoystickView* view)
+{
+  free(view->balls);
+  free(view->hats);
+  free(view->buttons);
+  free(view->axes);
+  free(view->sparks);
+  free(view->resolution_distinct);
+  free(view->button_transitions);
+
+  view->axes = NULL;
+  view->sparks = NULL;
+  view->resolution_distinct = NULL;
+  view->button_transitions = NULL;
+  view->buttons = NULL;
+  view->hats = NULL;
+  view->balls = NULL;
+  view->num_axes = 0;
+  view->num_buttons = 0;
+  view->num_hats = 0;
+  view->num_balls = 0;
+  view->valid = 0;
+}
+
+static void view_resize(JoystickView* view, WINDOW* win, const JoystickState* state)
+{
+  if (view->num_axes != state->num_axes ||
+      view->num_buttons != state->num_buttons ||
+      view->num_hats != state->num_hats ||
+      view->num_balls != state->num_balls)
+  {
+    free_values(view);
+
+    view->num_axes    = state->num_axes;
+    view->num_buttons = state->num_buttons;
+    view->num_hats    = state->num_hats;
+    view->num_balls   = state->num_balls;
+
+    view->axes    = calloc((size_t)view->num_axes,    sizeof(Sint16));
+    view->buttons = calloc((size_t)view->num_buttons, sizeof(Uint8));
+    view->hats    = calloc((size_t)view->num_hats,    sizeof(Uint8));
+    view->balls   = calloc((size_t)view->num_balls,   2*sizeof(Sint16));
+    view->resolution_distinct = calloc((size_t)view->num_axes, sizeof(Uint32));
+    view->button_transitions = calloc((size_t)view->num_buttons, sizeof(Uint32));
+  }
+
+  view->width  = getmaxx(win);
+  view->height = SDL_max(getmaxy(win) - 1, 1);
+
+  // the effective bits go to the end of the axis lines and a third of
+  // the remaining space right of the axis values to the sparklines,
+  // when there is room for them
+  int space = view->width - 20;
+  int resolution = space >= 30;
+  if (resolution)
+  {
+    space -= RESOLUTION_WIDTH;
+  }
+  view->spark_width = space >= 40 ? SDL_min(space / 3, JOYSTICK_VIEW_TEXT_MAX - 1) : 0;
+  widgets_resize(&view->widgets, view->spark_width ? space - view->spark_width - 2 : space);
+
+  view->resolution_x = 0;
+  if (resolution)
+  {
+    view->resolution_x = AXIS_BAR_X + view->widgets.bar_len + 2 +
+      (view->spark_width ? view->spark_width + 1 : 0);
+  }
+
+  free(view->sparks);
+  view->sparks = calloc((size_t)view->num_axes * (size_t)(view->spark_width + 1) + 1, 1);
+
+  view->button_columns = SDL_max((view->width - BUTTON_GRID_X) / BUTTON_CELL_WIDTH, 1);
+  int button_rows = (view->num_buttons + view->button_columns - 1) / view->button_columns;
+
+  // content lines, the label of each section is on the line above it
+  view->axes_y    = 3;
+  view->buttons_y = view->axes_y + view->num_axes + 2;
+  view->hats_y    = view->buttons_y + button_rows + 2;
+  view->balls_y   = view->hats_y + view->num_hats * HAT_LINES + 1;
+  view->end_y     = view->balls_y + SDL_max(view->num_balls, 1);
+
+  view->scroll = SDL_max(SDL_min(view->scroll, view->end_y - view->height), 0);
+}
+
+static void draw_all(JoystickView* view, WINDOW* win, const JoystickState* state)
+{
+  werase(win);
+  for(int i = 0; i < JOYSTICK_VIEW_TEXT_SLOTS; ++i)
+  {
+    view->text[i][0] = '\0';
+  }
+
+  view_print(view, win, 0, 0, "Joystick Number: %d", state->joy_idx);
+
+  Uint32 now = SDL_GetTicks();
+  view_print(view, win, view->axes_y - 1, 0, "Axes %2d:", state->num_axes);
+  for(int i = 0; i < state->num_axes; ++i)
+  {
+    draw_axis(view, win, i, state->axes[i]);
+    draw_spark(view, win, state, i, now);
+
+    // 0 distinct values can't happen, the initial value is always there
+    view->resolution_distinct[i] = 0;
+    draw_resolution(view, win, state, i);
+  }
+
+  view_print(view, win, view->buttons_y - 1, 0, "Buttons %2d:", state->num_buttons);
+  for(int i = 0; i < state->num_buttons; ++i)
+  {
+    draw_button(view, win, state, i);
+  }
+
+  view_print(view, win, view->hats_y - 1, 0, "Hats %2d:", state->num_hats);
+  for(int i = 0; i < state->num_hats; ++i)
+  {
+    draw_hat(view, win, i, state->hats[i]);
+  }
+
+  view_print(view, win, view->balls_y, 0, "Balls %2d: ", state->num_balls);
+  for(int i = 0; i < state->num_balls; ++i)
+  {
+    draw_ball(view, win, i, state->balls + 2*i);
+  }
+
+  memcpy(view->axes,    state->axes,    (size_t)state->num_axes    * sizeof(Sint16));
+  memcpy(view->hats,    state->hats,    (size_t)state->num_hats    * sizeof(Uint8));
+  memcpy(view->balls,   state->balls,   (size_t)state->num_balls   * 2*sizeof(Sint16));
+}
+
+static void draw_changes(JoystickView* view, WINDOW* win, const JoystickState* state)
+{
+  Uint32 now = SDL_GetTicks();
+  for(int i = 0; i < state->num_axes; ++i)
+  {
+    draw_spark(view, win, state, i, now);
+    draw_resolution(view, win, state, i);
+
+    if (view->axes[i] != state->axes[i])
+    {
+      int line = view->axes_y + i;
+      int old_pos = widget_bar_pos(&view->widgets, view->axes[i]);
+      int new_pos = widget_bar_pos(&view->widgets, state->axes[i]);
+
+      view_print(view, win, line, AXIS_VALUE_X, "%6d", state->axes[i]);
+      if (old_pos != new_pos)
+      {
+        view_cell(view, win, line, AXIS_BAR_X + old_pos, ' ');
+        view_cell(view, win, line, AXIS_BAR_X + new_pos, '#');
+      }
+      view->axes[i] = state->axes[i];
+    }
+  }
+
+  for(int i = 0; i < state->num_buttons; ++i)
+  {
+    // a press and release within one frame leaves the value as it
+    // was, but can still make it a bounce
+    if (view->buttons[i] != state->buttons[i] ||
+        view->button_transitions[i] != state->bounce.buttons[i].transitions)
+    {
+      draw_button(view, win, state, i);
+    }
+  }
+
+  for(int i = 0; i < state->num_hats; ++i)
+  {
+    if (view->hats[i] != state->hats[i])
+    {
+      draw_hat(view, win, i, state->hats[i]);
+      view->hats[i] = state->hats[i];
+    }
+  }
+
+  for(int i = 0; i < state->num_balls; ++i)
+  {
+    if (view->balls[2*i+0] != state->balls[2*i+0] ||
+        view->balls[2*i+1] != state->balls[2*i+1])
+    {
+      draw_ball(view, win, i, state->balls + 2*i);
+      view->balls[2*i+0] = state->balls[2*i+0];
+      view->balls[2*i+1] = state->balls[2*i+1];
+    }
+  }
+}
+
+void joystick_view_init(JoystickView* view)
+{
+  memset(view, 0, sizeof(JoystickView));
+  widgets_init(&view->widgets);
+}
+
+void joystick_view_free(JoystickView* view)
+{
+  free_values(view);
+  widgets_free(&view->widgets);
+}
+
+void joystick_view_invalidate(JoystickView* view)
+{
+  view->valid = 0;
+  for(int i = 0; i < JOYSTICK_VIEW_TEXT_SLOTS; ++i)
+  {
+    view->text[i][0] = '\0';
+  }
+}
+
+void joystick_view_begin(JoystickView* view)
+{
+  view->cells = 0;
+}
+
+void joystick_view_scroll(JoystickView* view, int lines)
+{
+  // clamped by view_resize() as part of the full redraw
+  view->scroll = SDL_max(SDL_min(view->scroll + lines, view->end_y), 0);
+  view->valid = 0;
+}
+
+void joystick_view_draw(JoystickView* view, WINDOW* win, const JoystickState* state)
+{
+  if (!view->valid ||
+      view->width != getmaxx(win) ||
+      view->height != SDL_max(getmaxy(win) - 1, 1) ||
+      view->num_axes != state->num_axes ||
+      view->num_buttons != state->num_buttons ||
+      view->num_hats != state->num_hats ||
+      view->num_balls != state->num_balls)
+  {
+    view_resize(view, win, state);
+    draw_all(view, win, state);
+    view->valid = 1;
+  }
+  else
+  {
+    draw_changes(view, win, state);
+  }
+
+  char header[JOYSTICK_VIEW_TEXT_MAX];
+  snprintf(header, sizeof(header), "Joystick Name:   '%s'   Rate: %6.1f Hz  Jitter: %6.3f ms",
+           state->name,
+           rate_estimator_live_rate(&state->rate, SDL_GetTicks()),
+           rate_estimator_jitter(&state->rate));
+  if (view->bounce_ms > 0)
+  {
+    uint32_t bounces = button_bounce_total(&state->bounce, view->bounce_ms);
+    if (bounces)
+    {
+      size_t len = strlen(header);
+      snprintf(header + len, sizeof(header) - len, "  Bounces: %u", bounces);
+    }
+  }
+  joystick_view_text(view, win, JOYSTICK_VIEW_SLOT_HEADER, 0, header);
+}
+
+void joystick_view_text(JoystickView* view, WINDOW* win, int slot, int y, const char* text)
+{
+  if (strcmp(view->text[slot], text) != 0)
+  {
+    mvwaddstr(win, y, 0, text);
+    wclrtoeol(win);
+    view->cells += strlen(text);
+
+    strncpy(view->text[slot], text, JOYSTICK_VIEW_TEXT_MAX - 1);
+    view->text[slot][JOYSTICK_VIEW_TEXT_MAX - 1] = '\0';
+  }
+}
+
+/* EOF */
@@ -0,0 +1,116 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_JOYSTICK_VIEW_H
+#define HEADER_SDL_JSTEST_JOYSTICK_VIEW_H
+
+#include <curses.h>
+
+#include "joystick_state.h"
+#include "widgets.h"
+
+// Number of text lines whose content is cached by joystick_view_text()
+#define JOYSTICK_VIEW_TEXT_SLOTS 4
+#define JOYSTICK_VIEW_TEXT_MAX   256
+
+// Slot used for the name and rate line of the joystick
+#define JOYSTICK_VIEW_SLOT_HEADER 0
+
+// Time span covered by the axis sparklines
+#define JOYSTICK_VIEW_HISTORY_MS 1000
+
+// The full --test view of a single joystick. It remembers the values
+// that are on screen and only redraws the widgets whose value changed,
+// a moved axis only touches its number and the two cells of the bar
+// that changed. Everything is redrawn after joystick_view_invalidate(),
+// after scrolling or when the window size changed.
+//
+// Line 0 of the window shows the name of the joystick, the rest is a
+// viewport into the axes, buttons, hats and balls, so joysticks with
+// hundreds of controls can be scrolled through. Only the lines inside
+// the viewport are drawn.
+typedef struct
+{
+  int valid;
+  int width;
+  int height;  // lines of the viewport
+  int scroll;  // first content line in the viewport
+  Widgets widgets;
+
+  int num_axes;
+  int num_buttons;
+  int num_hats;
+  int num_balls;
+
+  Sint16* axes;
+  Uint8*  buttons;
+  Uint8*  hats;
+  Sint16* balls;
+
+  // first content line of each section
+  int axes_y;
+  int buttons_y;
+  int hats_y;
+  int balls_y;
+  int end_y;     // number of content lines
+  int button_columns;
+
+  // sparkline of the recent axis history right of each bar, 0 when
+  // the window is too narrow, sparks holds what is on screen
+  int spark_width;
+  char* sparks;
+
+  // column of the effective bits of each axis at the end of its line,
+  // 0 when the window is too narrow. The number of distinct values
+  // they were computed from, to skip axes that saw nothing new.
+  int resolution_x;
+  Uint32* resolution_distinct;
+
+  // buttons with presses or gaps shorter than bounce_ms get marked
+  // with a '!', 0 turns that off. The transitions of each button that
+  // are on screen.
+  int bounce_ms;
+  Uint32* button_transitions;
+
+  char text[JOYSTICK_VIEW_TEXT_SLOTS][JOYSTICK_VIEW_TEXT_MAX];
+
+  // cells written since joystick_view_begin()
+  unsigned long cells;
+} JoystickView;
+
+void joystick_view_init(JoystickView* view);
+void joystick_view_free(JoystickView* view);
+
+// Forget what is on screen, e.g. after clear()
+void joystick_view_invalidate(JoystickView* view);
+
+// Start a new frame, resets the cell counter
+void joystick_view_begin(JoystickView* view);
+
+// Bring the view of state up to date
+void joystick_view_draw(JoystickView* view, WINDOW* win, const JoystickState* state);
+
+// Move the viewport by the given number of lines, it stops at the top
+// and the bottom of the content
+void joystick_view_scroll(JoystickView* view, int lines);
+
+// Write text to line y unless the same text is already there, slot
+// identifies the line across frames
+void joystick_view_text(JoystickView* view, WINDOW* win, int slot, int y, const char* text);
+
+#endif
+
+/* EOF */
@@ -0,0 +1,111 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "latency.h"
+
+typedef struct
+{
+  Uint32 type;
+  const char* name;
+} EventTypeName;
+
+static const EventTypeName event_types[LATENCY_EVENT_TYPES] = {
+  { SDL_JOYAXISMOTION,            "SDL_JOYAXISMOTION" },
+  { SDL_JOYBALLMOTION,            "SDL_JOYBALLMOTION" },
+  { SDL_JOYHATMOTION,             "SDL_JOYHATMOTION" },
+  { SDL_JOYBUTTONDOWN,            "SDL_JOYBUTTONDOWN" },
+  { SDL_JOYBUTTONUP,              "SDL_JOYBUTTONUP" },
+  { SDL_JOYDEVICEADDED,           "SDL_JOYDEVICEADDED" },
+  { SDL_JOYDEVICEREMOVED,         "SDL_JOYDEVICEREMOVED" },
+  { SDL_CONTROLLERAXISMOTION,     "SDL_CONTROLLERAXISMOTION" },
+  { SDL_CONTROLLERBUTTONDOWN,     "SDL_CONTROLLERBUTTONDOWN" },
+  { SDL_CONTROLLERBUTTONUP,       "SDL_CONTROLLERBUTTONUP" },
+  { SDL_CONTROLLERDEVICEADDED,    "SDL_CONTROLLERDEVICEADDED" },
+  { SDL_CONTROLLERDEVICEREMOVED,  "SDL_CONTROLLERDEVICEREMOVED" },
+  { SDL_CONTROLLERDEVICEREMAPPED, "SDL_CONTROLLERDEVICEREMAPPED" },
+#if SDL_VERSION_ATLEAST(2, 0, 14)
+  { SDL_CONTROLLERTOUCHPADMOTION, "SDL_CONTROLLERTOUCHPADMOTION" },
+  { SDL_CONTROLLERSENSORUPDATE,   "SDL_CONTROLLERSENSORUPDATE" },
+#else
+  { 0, NULL },
+  { 0, NULL },
+#endif
+  { 0, NULL }
+};
+
+static int event_type_index(Uint32 type)
+{
+  for(int i = 0; i < LATENCY_EVENT_TYPES; ++i)
+  {
+    if (event_types[i].name && event_types[i].type == type)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void latency_stats_init(LatencyStats* stats)
+{
+  for(int i = 0; i < LATENCY_EVENT_TYPES; ++i)
+  {
+    histogram_init(&stats->hists[i]);
+  }
+}
+
+void latency_stats_add(LatencyStats* stats, const SDL_Event* event, Uint32 now)
+{
+  int idx = event_type_index(event->type);
+  if (idx >= 0)
+  {
+    // timestamps can't be in the future, but the tick counter wraps
+    // after 49 days, so go through a signed difference
+    Sint32 latency = (Sint32)(now - event->common.timestamp);
+    histogram_add(&stats->hists[idx], latency < 0 ? 0 : (Uint32)latency);
+  }
+}
+
+void latency_stats_print(const LatencyStats* stats, FILE* out)
+{
+  fprintf(out, "Event delivery latency in ms (dequeue time - event timestamp):\n");
+  fprintf(out, "  %-30s %10s %7s %5s %5s %5s %5s\n",
+          "Event", "Count", "Mean", "p50", "p90", "p99", "Max");
+
+  int empty = 1;
+  for(int i = 0; i < LATENCY_EVENT_TYPES; ++i)
+  {
+    const Histogram* hist = &stats->hists[i];
+    if (hist->count > 0)
+    {
+      empty = 0;
+      fprintf(out, "  %-30s %10llu %7.2f %5u %5u %5u %5u\n",
+              event_types[i].name,
+              (unsigned long long)hist->count,
+              histogram_mean(hist),
+              (unsigned)histogram_percentile(hist, 50.0),
+              (unsigned)histogram_percentile(hist, 90.0),
+              (unsigned)histogram_percentile(hist, 99.0),
+              (unsigned)hist->max);
+    }
+  }
+
+  if (empty)
+  {
+    fprintf(out, "  no joystick events were received\n");
+  }
+}
+
+/* EOF */
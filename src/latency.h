@@ -0,0 +1,46 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_LATENCY_H
+#define HEADER_SDL_JSTEST_LATENCY_H
+
+#include <SDL.h>
+#include <stdio.h>
+
+#include "histogram.h"
+
+#define LATENCY_EVENT_TYPES 16
+
+// Delivery latency of joystick and gamecontroller events, that is the
+// time between SDL stamping an event and the program dequeuing it.
+// SDL2 timestamps are in milliseconds, so is everything here.
+typedef struct
+{
+  Histogram hists[LATENCY_EVENT_TYPES];
+} LatencyStats;
+
+void latency_stats_init(LatencyStats* stats);
+
+// Record the latency of event when it is dequeued at SDL_GetTicks()
+// time now, events that are not joystick or gamecontroller events
+// are ignored
+void latency_stats_add(LatencyStats* stats, const SDL_Event* event, Uint32 now);
+
+void latency_stats_print(const LatencyStats* stats, FILE* out);
+
+#endif
+
+/* EOF */
@@ -0,0 +1,100 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "loop_stats.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#  include <windows.h>
+#else
+#  include <poll.h>
+#  include <unistd.h>
+#endif
+
+static double clock_to_ms(clock_t c)
+{
+  return (double)c * 1000.0 / CLOCKS_PER_SEC;
+}
+
+void loop_stats_init(LoopStats* stats, unsigned int ticks)
+{
+  stats->start_ticks = ticks;
+  stats->start_clock = clock();
+  stats->wakeups = 0;
+
+  stats->window_ticks = stats->start_ticks;
+  stats->window_clock = stats->start_clock;
+  stats->window_wakeups = 0;
+
+  stats->wakeups_per_sec = 0.0;
+  stats->cpu_percent = 0.0;
+}
+
+int loop_stats_wakeup(LoopStats* stats, unsigned int ticks)
+{
+  stats->wakeups += 1;
+  stats->window_wakeups += 1;
+
+  unsigned int elapsed = ticks - stats->window_ticks;
+  if (elapsed < 1000)
+  {
+    return 0;
+  }
+  else
+  {
+    clock_t now = clock();
+
+    stats->wakeups_per_sec = (double)stats->window_wakeups * 1000.0 / elapsed;
+    stats->cpu_percent = clock_to_ms(now - stats->window_clock) * 100.0 / elapsed;
+
+    stats->window_ticks = ticks;
+    stats->window_clock = now;
+    stats->window_wakeups = 0;
+    return 1;
+  }
+}
+
+void loop_stats_print(const LoopStats* stats, const char* mode, unsigned int ticks, FILE* out)
+{
+  unsigned int elapsed = ticks - stats->start_ticks;
+  double cpu_ms = clock_to_ms(clock() - stats->start_clock);
+
+  fprintf(out, "Loop statistics (%s):\n", mode);
+  fprintf(out, "  Runtime:  %.1f s\n", elapsed / 1000.0);
+  fprintf(out, "  Wakeups:  %lu (%.1f/s)\n", stats->wakeups,
+          elapsed ? (double)stats->wakeups * 1000.0 / elapsed : 0.0);
+  fprintf(out, "  CPU time: %.1f ms (%.2f%%)\n", cpu_ms,
+          elapsed ? cpu_ms * 100.0 / elapsed : 0.0);
+}
+
+int wait_for_terminal(int timeout_ms)
+{
+#ifdef _WIN32
+  return WaitForSingleObject(GetStdHandle(STD_INPUT_HANDLE), (DWORD)timeout_ms) == WAIT_OBJECT_0;
+#else
+  struct pollfd pfd;
+  pfd.fd = STDIN_FILENO;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+
+  // EINTR, e.g. from SIGINT or SIGWINCH, is treated like a timeout,
+  // the caller will pick up the resulting events anyway
+  return poll(&pfd, 1, timeout_ms) > 0;
+#endif
+}
+
+/* EOF */
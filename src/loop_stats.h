@@ -0,0 +1,64 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_LOOP_STATS_H
+#define HEADER_SDL_JSTEST_LOOP_STATS_H
+
+#include <stdio.h>
+#include <time.h>
+
+// Shortest and longest time the --wait loop sleeps on the terminal
+// before pumping the joystick again. The timeout doubles on every
+// wakeup that didn't produce an event and drops back to the minimum
+// as soon as one arrives. The maximum is the 10ms of the polling loop,
+// so the first event after an idle phase doesn't show up any later.
+#define WAIT_TIMEOUT_MIN  1
+#define WAIT_TIMEOUT_MAX 10
+
+// Counts how often the --test loop wakes up and how much CPU time it
+// burns, so that the polling and the waiting loop can be compared.
+// Times are in milliseconds as returned by SDL_GetTicks().
+typedef struct
+{
+  unsigned int start_ticks;
+  clock_t start_clock;
+  unsigned long wakeups;
+
+  unsigned int window_ticks;
+  clock_t window_clock;
+  unsigned long window_wakeups;
+
+  // values of the last completed one second window
+  double wakeups_per_sec;
+  double cpu_percent;
+} LoopStats;
+
+void loop_stats_init(LoopStats* stats, unsigned int ticks);
+
+// Count one loop iteration, returns 1 when a new one second window
+// was completed and the per second values got updated
+int loop_stats_wakeup(LoopStats* stats, unsigned int ticks);
+
+// Print the totals since loop_stats_init()
+void loop_stats_print(const LoopStats* stats, const char* mode, unsigned int ticks, FILE* out);
+
+// Sleep until input is pending on the terminal or timeout_ms have
+// passed, returns 1 when input is pending
+int wait_for_terminal(int timeout_ms);
+
+#endif
+
+/* EOF */
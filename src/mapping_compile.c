@@ -0,0 +1,56 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Compiles gamecontrollerdb.txt into the table read by sdl2-jstest at
+// startup, run by the build. It keeps the mappings for the platform it
+// runs on.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <SDL.h>
+
+#include "mapping_table.h"
+#include "mappings.h"
+
+int main(int argc, char** argv)
+{
+  if (argc != 3)
+  {
+    fprintf(stderr, "Usage: %s GAMECONTROLLERDB.TXT OUTPUT\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  MappingDB db;
+  if (mapping_db_load(&db, argv[1]) < 0)
+  {
+    fprintf(stderr, "error: %s\n", SDL_GetError());
+    return EXIT_FAILURE;
+  }
+
+  if (mapping_table_write(&db, argv[2]) < 0)
+  {
+    fprintf(stderr, "error: %s\n", SDL_GetError());
+    mapping_db_free(&db);
+    return EXIT_FAILURE;
+  }
+
+  printf("%s: %d of %d mappings for %s\n", argv[2], db.num_entries, db.num_lines, SDL_GetPlatform());
+  mapping_db_free(&db);
+  return EXIT_SUCCESS;
+}
+
+/* EOF */
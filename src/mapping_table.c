@@ -0,0 +1,415 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "mapping_table.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#  include <sys/stat.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+// Slots per GUID and GUIDs per bucket, a bit of slack in the slots
+// keeps the search for the seeds short
+#define MAPPING_TABLE_SLOT_PERCENT 125
+#define MAPPING_TABLE_BUCKET_SIZE  4
+
+// Give up on a bucket after this many seeds
+#define MAPPING_TABLE_MAX_SEED 1000000
+
+struct MappingTable
+{
+  char* data;
+  size_t size;
+  int mapped;
+
+  const MappingTableHeader* header;
+  const Uint32* seeds;
+  const MappingTableSlot* slots;
+  const char* strings;
+};
+
+// FNV-1a with a seed and a final mix, as the low bits of plain FNV-1a
+// spread badly over small tables
+static Uint32 hash_guid(const char* guid, Uint32 seed)
+{
+  Uint32 h = 2166136261u ^ (seed * 0x9e3779b9u);
+  for(int i = 0; i < MAPPING_GUID_LENGTH; ++i)
+  {
+    h ^= (unsigned char)guid[i];
+    h *= 16777619u;
+  }
+
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  return h;
+}
+
+static int table_fail(const char* path, const char* reason)
+{
+  SDL_SetError("%s: %s", path, reason);
+  return -1;
+}
+
+// Check that everything the header promises is inside the file
+static int table_check(MappingTable* table, const char* path)
+{
+  if (table->size < sizeof(MappingTableHeader))
+  {
+    return table_fail(path, "file too short");
+  }
+
+  const MappingTableHeader* header = (const MappingTableHeader*)table->data;
+  if (memcmp(header->magic, MAPPING_TABLE_MAGIC, sizeof(header->magic)) != 0)
+  {
+    return table_fail(path, "not a mapping table");
+  }
+
+  if (header->platform[MAPPING_TABLE_PLATFORM_MAX - 1] != '\0' ||
+      strcmp(header->platform, SDL_GetPlatform()) != 0)
+  {
+    return table_fail(path, "built for another platform");
+  }
+
+  Uint64 size = (Uint64)sizeof(MappingTableHeader) +
+    (Uint64)header->num_buckets * sizeof(Uint32) +
+    (Uint64)header->num_slots * sizeof(MappingTableSlot) +
+    header->strings_size;
+  if (header->num_buckets == 0 || header->num_slots == 0 || size != table->size ||
+      header->strings_size == 0)
+  {
+    return table_fail(path, "size doesn't match the header");
+  }
+
+  table->header = header;
+  table->seeds = (const Uint32*)(table->data + sizeof(MappingTableHeader));
+  table->slots = (const MappingTableSlot*)(table->seeds + header->num_buckets);
+  table->strings = (const char*)(table->slots + header->num_slots);
+
+  // every line ends within the strings as the last byte is a NUL
+  if (table->strings[header->strings_size - 1] != '\0')
+  {
+    return table_fail(path, "strings not terminated");
+  }
+
+  return 0;
+}
+
+static int table_map(MappingTable* table, const char* path)
+{
+#ifdef _WIN32
+  FILE* fp = fopen(path, "rb");
+  if (!fp)
+  {
+    SDL_SetError("couldn't open %s: %s", path, strerror(errno));
+    return -1;
+  }
+
+  struct stat st;
+  if (fstat(fileno(fp), &st) < 0)
+  {
+    fclose(fp);
+    SDL_SetError("couldn't stat %s: %s", path, strerror(errno));
+    return -1;
+  }
+
+  char* data = malloc((size_t)st.st_size + 1);
+  table->size = fread(data, 1, (size_t)st.st_size, fp);
+  table->data = data;
+  fclose(fp);
+  return 0;
+#else
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    SDL_SetError("couldn't open %s: %s", path, strerror(errno));
+    return -1;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) < 0 || st.st_size == 0)
+  {
+    close(fd);
+    SDL_SetError("couldn't map %s: empty or unreadable", path);
+    return -1;
+  }
+
+  void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    SDL_SetError("couldn't map %s: %s", path, strerror(errno));
+    return -1;
+  }
+
+  table->data = data;
+  table->size = (size_t)st.st_size;
+  table->mapped = 1;
+  return 0;
+#endif
+}
+
+MappingTable* mapping_table_open(const char* path)
+{
+  MappingTable* table = calloc(1, sizeof(MappingTable));
+  if (table_map(table, path) < 0)
+  {
+    free(table);
+    return NULL;
+  }
+
+  if (table_check(table, path) < 0)
+  {
+    mapping_table_close(table);
+    return NULL;
+  }
+
+  return table;
+}
+
+void mapping_table_close(MappingTable* table)
+{
+#ifndef _WIN32
+  if (table->mapped)
+  {
+    munmap(table->data, table->size);
+  }
+  else
+#endif
+  {
+    free(table->data);
+  }
+  free(table);
+}
+
+const MappingTableHeader* mapping_table_header(const MappingTable* table)
+{
+  return table->header;
+}
+
+const char* mapping_table_find(const MappingTable* table, const char* guid)
+{
+  const MappingTableHeader* header = table->header;
+  Uint32 bucket = hash_guid(guid, 0) % header->num_buckets;
+  Uint32 slot = hash_guid(guid, table->seeds[bucket]) % header->num_slots;
+
+  const MappingTableSlot* entry = &table->slots[slot];
+  if (entry->line == MAPPING_TABLE_EMPTY || entry->line >= header->strings_size ||
+      memcmp(entry->guid, guid, MAPPING_GUID_LENGTH) != 0)
+  {
+    return NULL;
+  }
+  return table->strings + entry->line;
+}
+
+typedef struct
+{
+  Uint32 bucket;
+  int first;  // index of the first entry in the sorted order
+  int count;
+} BucketRange;
+
+typedef struct
+{
+  Uint32 bucket;
+  int entry;
+} BucketEntry;
+
+static int compare_bucket_entries(const void* lhs, const void* rhs)
+{
+  const BucketEntry* a = lhs;
+  const BucketEntry* b = rhs;
+  return (a->bucket > b->bucket) - (a->bucket < b->bucket);
+}
+
+static int compare_bucket_ranges(const void* lhs, const void* rhs)
+{
+  const BucketRange* a = lhs;
+  const BucketRange* b = rhs;
+  // the biggest buckets first, while most slots are still free
+  return b->count - a->count;
+}
+
+// Find a seed for every bucket so that all GUIDs land in a slot of
+// their own, "hash, displace and compress" without the compression
+static int find_seeds(const MappingDB* db, Uint32* seeds, Uint32 num_buckets,
+                      MappingTableSlot* slots, Uint32 num_slots)
+{
+  int n = db->num_entries;
+  BucketEntry* order = calloc((size_t)n + 1, sizeof(BucketEntry));
+  BucketRange* ranges = calloc((size_t)num_buckets, sizeof(BucketRange));
+  Uint32* taken = calloc((size_t)MAPPING_TABLE_BUCKET_SIZE * 8, sizeof(Uint32));
+  int num_ranges = 0;
+
+  for(int i = 0; i < n; ++i)
+  {
+    order[i].bucket = hash_guid(db->entries[i].guid, 0) % num_buckets;
+    order[i].entry = i;
+  }
+  qsort(order, (size_t)n, sizeof(BucketEntry), compare_bucket_entries);
+
+  for(int i = 0; i < n; ++i)
+  {
+    if (i == 0 || order[i].bucket != order[i - 1].bucket)
+    {
+      ranges[num_ranges].bucket = order[i].bucket;
+      ranges[num_ranges].first = i;
+      num_ranges += 1;
+    }
+    ranges[num_ranges - 1].count += 1;
+  }
+  qsort(ranges, (size_t)num_ranges, sizeof(BucketRange), compare_bucket_ranges);
+
+  int ret = 0;
+  int taken_size = MAPPING_TABLE_BUCKET_SIZE * 8;
+  for(int r = 0; r < num_ranges && ret == 0; ++r)
+  {
+    const BucketRange* range = &ranges[r];
+    if (range->count > taken_size)
+    {
+      taken_size = range->count;
+      taken = realloc(taken, (size_t)taken_size * sizeof(Uint32));
+    }
+
+    Uint32 seed;
+    for(seed = 1; seed <= MAPPING_TABLE_MAX_SEED; ++seed)
+    {
+      int ok = 1;
+      for(int i = 0; i < range->count && ok; ++i)
+      {
+        const char* guid = db->entries[order[range->first + i].entry].guid;
+        taken[i] = hash_guid(guid, seed) % num_slots;
+        ok = slots[taken[i]].line == MAPPING_TABLE_EMPTY;
+        for(int j = 0; j < i && ok; ++j)
+        {
+          ok = taken[j] != taken[i];
+        }
+      }
+
+      if (ok)
+      {
+        break;
+      }
+    }
+
+    if (seed > MAPPING_TABLE_MAX_SEED)
+    {
+      SDL_SetError("no perfect hash found for bucket %u", range->bucket);
+      ret = -1;
+    }
+    else
+    {
+      seeds[range->bucket] = seed;
+      for(int i = 0; i < range->count; ++i)
+      {
+        // the line offsets are filled in by the caller, mark the slot
+        // as used for now
+        int entry = order[range->first + i].entry;
+        memcpy(slots[taken[i]].guid, db->entries[entry].guid, MAPPING_GUID_LENGTH);
+        slots[taken[i]].line = (Uint32)entry;
+      }
+    }
+  }
+
+  free(taken);
+  free(ranges);
+  free(order);
+  return ret;
+}
+
+int mapping_table_write(const MappingDB* db, const char* path)
+{
+  MappingTableHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAPPING_TABLE_MAGIC, sizeof(header.magic));
+  SDL_strlcpy(header.platform, SDL_GetPlatform(), sizeof(header.platform));
+  header.num_lines = (Uint32)db->num_lines;
+  header.num_entries = (Uint32)db->num_entries;
+  header.num_buckets = (Uint32)(db->num_entries / MAPPING_TABLE_BUCKET_SIZE + 1);
+  header.num_slots = (Uint32)(db->num_entries * MAPPING_TABLE_SLOT_PERCENT / 100 + 1);
+
+  Uint32* seeds = calloc(header.num_buckets, sizeof(Uint32));
+  MappingTableSlot* slots = calloc(header.num_slots, sizeof(MappingTableSlot));
+  for(Uint32 i = 0; i < header.num_slots; ++i)
+  {
+    slots[i].line = MAPPING_TABLE_EMPTY;
+  }
+
+  int ret = find_seeds(db, seeds, header.num_buckets, slots, header.num_slots);
+  if (ret == 0)
+  {
+    // the strings in the order of the entries, at least one NUL so an
+    // empty table is still valid
+    Uint32* offsets = calloc((size_t)db->num_entries + 1, sizeof(Uint32));
+    size_t strings_size = 0;
+    for(int i = 0; i < db->num_entries; ++i)
+    {
+      offsets[i] = (Uint32)strings_size;
+      strings_size += strlen(db->entries[i].line) + 1;
+    }
+    header.strings_size = (Uint32)(strings_size + 1);
+
+    for(Uint32 i = 0; i < header.num_slots; ++i)
+    {
+      if (slots[i].line != MAPPING_TABLE_EMPTY)
+      {
+        slots[i].line = offsets[slots[i].line];
+      }
+    }
+
+    FILE* fp = fopen(path, "wb");
+    if (!fp)
+    {
+      SDL_SetError("couldn't open %s: %s", path, strerror(errno));
+      ret = -1;
+    }
+    else
+    {
+      fwrite(&header, sizeof(header), 1, fp);
+      fwrite(seeds, sizeof(Uint32), header.num_buckets, fp);
+      fwrite(slots, sizeof(MappingTableSlot), header.num_slots, fp);
+      for(int i = 0; i < db->num_entries; ++i)
+      {
+        fwrite(db->entries[i].line, 1, strlen(db->entries[i].line) + 1, fp);
+      }
+      fputc('\0', fp);
+
+      if (fclose(fp) != 0)
+      {
+        SDL_SetError("couldn't write %s: %s", path, strerror(errno));
+        ret = -1;
+      }
+    }
+    free(offsets);
+  }
+
+  free(slots);
+  free(seeds);
+  return ret;
+}
+
+/* EOF */
@@ -0,0 +1,75 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_MAPPING_TABLE_H
+#define HEADER_SDL_JSTEST_MAPPING_TABLE_H
+
+#include <SDL.h>
+
+#include "mappings.h"
+
+// gamecontrollerdb.txt compiled at build time into a table with a
+// perfect hash over the GUIDs, so the start of sdl2-jstest costs a
+// mmap() and one probe per device instead of parsing the whole text.
+//
+// The file starts with a MappingTableHeader, followed by one seed per
+// bucket, the slots and the NUL terminated mapping lines. The first
+// hash of a GUID picks its bucket, the seed of the bucket gives the
+// second hash that picks its slot, and no two GUIDs share a slot. All
+// values are in the byte order of the machine that built the table,
+// which only holds the mappings for its platform.
+#define MAPPING_TABLE_MAGIC "SJMAPDB1"
+#define MAPPING_TABLE_PLATFORM_MAX 32
+
+typedef struct
+{
+  char magic[8];
+  char platform[MAPPING_TABLE_PLATFORM_MAX];
+  Uint32 num_lines;    // mapping lines for any platform in the source
+  Uint32 num_entries;
+  Uint32 num_buckets;
+  Uint32 num_slots;
+  Uint32 strings_size;
+} MappingTableHeader;
+
+typedef struct
+{
+  char guid[MAPPING_GUID_LENGTH];  // lower case hex, not terminated
+  Uint32 line;                     // offset into the strings, or MAPPING_TABLE_EMPTY
+} MappingTableSlot;
+
+#define MAPPING_TABLE_EMPTY 0xffffffffu
+
+typedef struct MappingTable MappingTable;
+
+// Map the table in path, returns NULL when it is missing, broken or
+// built for another platform, the error is available from
+// SDL_GetError()
+MappingTable* mapping_table_open(const char* path);
+void mapping_table_close(MappingTable* table);
+
+const MappingTableHeader* mapping_table_header(const MappingTable* table);
+
+// The mapping filed under guid, a lower case GUID string, or NULL
+const char* mapping_table_find(const MappingTable* table, const char* guid);
+
+// Build a table from the entries of a text MappingDB, returns 0 on
+// success and -1 on error
+int mapping_table_write(const MappingDB* db, const char* path);
+
+#endif
+
+/* EOF */
@@ -0,0 +1,579 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "mappings.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "mapping_table.h"
+
+#define PLATFORM_FIELD "platform:"
+
+// Values of SDL_HARDWARE_BUS_*, which older SDL versions don't have
+#define BUS_USB       0x03
+#define BUS_BLUETOOTH 0x05
+#define BUS_VIRTUAL   0xff
+
+// Hex digits of the CRC and the version in a GUID string
+#define GUID_CRC_OFFSET     4
+#define GUID_VERSION_OFFSET 24
+
+static char* read_file(const char* path)
+{
+  FILE* fp = fopen(path, "rb");
+  if (!fp)
+  {
+    SDL_SetError("couldn't open %s: %s", path, strerror(errno));
+    return NULL;
+  }
+
+  char* data = NULL;
+  size_t size = 0;
+  size_t capacity = 0;
+  for(;;)
+  {
+    if (capacity - size < 4096)
+    {
+      capacity = capacity ? capacity * 2 : 256 * 1024;
+      data = realloc(data, capacity + 1);
+    }
+
+    size_t len = fread(data + size, 1, capacity - size, fp);
+    size += len;
+    if (len == 0)
+    {
+      break;
+    }
+  }
+
+  int error = ferror(fp);
+  fclose(fp);
+  if (error)
+  {
+    SDL_SetError("couldn't read %s", path);
+    free(data);
+    return NULL;
+  }
+
+  data[size] = '\0';
+  return data;
+}
+
+// Platform of the line, the value is terminated by ',' and not by NUL
+static const char* line_platform(const char* line)
+{
+  const char* platform = strstr(line, PLATFORM_FIELD);
+  return platform ? platform + strlen(PLATFORM_FIELD) : NULL;
+}
+
+static int platform_matches(const char* value, const char* platform)
+{
+  size_t len = strlen(platform);
+  return SDL_strncasecmp(value, platform, len) == 0 && (value[len] == ',' || value[len] == '\0');
+}
+
+static int compare_entries(const void* lhs, const void* rhs)
+{
+  const MappingEntry* a = lhs;
+  const MappingEntry* b = rhs;
+  int ret = strcmp(a->guid, b->guid);
+  if (ret != 0)
+  {
+    return ret;
+  }
+  else
+  {
+    // keep the order of the file, the lines point into a single buffer
+    return (a->line > b->line) - (a->line < b->line);
+  }
+}
+
+// Index the lines in db->data. A file only counts the lines with a
+// platform field, SDL_GAMECONTROLLERCONFIG takes every line.
+static void index_lines(MappingDB* db, int need_platform)
+{
+  const char* platform = SDL_GetPlatform();
+  int capacity = 0;
+
+  char* line = db->data;
+  while (*line)
+  {
+    char* end = strchr(line, '\n');
+    char* next = end ? end + 1 : line + strlen(line);
+    if (end)
+    {
+      *end = '\0';
+      if (end > line && end[-1] == '\r')
+      {
+        end[-1] = '\0';
+      }
+    }
+
+    // only lines for this platform, like SDL_GameControllerAddMappingsFromFile()
+    const char* value = line_platform(line);
+    if (line[0] != '#' && line[0] != '\0' && (value || !need_platform))
+    {
+      db->num_lines += 1;
+
+      const char* comma = strchr(line, ',');
+      if ((!value || platform_matches(value, platform)) && comma && comma - line == MAPPING_GUID_LENGTH)
+      {
+        if (db->num_entries == capacity)
+        {
+          capacity = capacity ? capacity * 2 : 1024;
+          db->entries = realloc(db->entries, (size_t)capacity * sizeof(MappingEntry));
+        }
+
+        MappingEntry* entry = &db->entries[db->num_entries++];
+        for(int i = 0; i < MAPPING_GUID_LENGTH; ++i)
+        {
+          entry->guid[i] = (char)tolower((unsigned char)line[i]);
+        }
+        entry->guid[MAPPING_GUID_LENGTH] = '\0';
+        entry->line = line;
+      }
+    }
+
+    line = next;
+  }
+
+  qsort(db->entries, (size_t)db->num_entries, sizeof(MappingEntry), compare_entries);
+
+  // the last line for a GUID replaces the ones before, as it would
+  // when they get added one after another
+  int out = 0;
+  for(int i = 0; i < db->num_entries; ++i)
+  {
+    if (out > 0 && strcmp(db->entries[out - 1].guid, db->entries[i].guid) == 0)
+    {
+      db->entries[out - 1] = db->entries[i];
+    }
+    else
+    {
+      db->entries[out++] = db->entries[i];
+    }
+  }
+  db->num_entries = out;
+}
+
+int mapping_db_load(MappingDB* db, const char* path)
+{
+  memset(db, 0, sizeof(*db));
+
+  db->data = read_file(path);
+  if (!db->data)
+  {
+    return -1;
+  }
+  db->source = SDL_strdup(path);
+
+  index_lines(db, 1);
+  return 0;
+}
+
+void mapping_db_load_string(MappingDB* db, const char* source, const char* text)
+{
+  memset(db, 0, sizeof(*db));
+
+  size_t len = strlen(text);
+  db->data = malloc(len + 1);
+  memcpy(db->data, text, len + 1);
+  db->source = SDL_strdup(source);
+
+  index_lines(db, 0);
+}
+
+int mapping_db_load_table(MappingDB* db, const char* path)
+{
+  memset(db, 0, sizeof(*db));
+
+  db->table = mapping_table_open(path);
+  if (!db->table)
+  {
+    return -1;
+  }
+
+  const MappingTableHeader* header = mapping_table_header(db->table);
+  db->source = SDL_strdup(path);
+  db->num_entries = (int)header->num_entries;
+  db->num_lines = (int)header->num_lines;
+  return 0;
+}
+
+int mapping_db_open(MappingDB* db, const char* dir)
+{
+  char txt[4096];
+  char bin[4096];
+  snprintf(txt, sizeof(txt), "%s/gamecontrollerdb.txt", dir);
+  snprintf(bin, sizeof(bin), "%s/gamecontrollerdb.bin", dir);
+
+  struct stat txt_st;
+  struct stat bin_st;
+  int have_txt = stat(txt, &txt_st) == 0;
+  int have_bin = stat(bin, &bin_st) == 0;
+
+  if (have_bin && (!have_txt || bin_st.st_mtime >= txt_st.st_mtime) &&
+      mapping_db_load_table(db, bin) == 0)
+  {
+    return 0;
+  }
+  else
+  {
+    return mapping_db_load(db, txt);
+  }
+}
+
+void mapping_db_free(MappingDB* db)
+{
+  if (db->table)
+  {
+    mapping_table_close(db->table);
+  }
+  free(db->entries);
+  free(db->data);
+  SDL_free(db->source);
+  memset(db, 0, sizeof(*db));
+}
+
+const char* mapping_db_find_exact(const MappingDB* db, const char* guid)
+{
+  if (db->table)
+  {
+    return mapping_table_find(db->table, guid);
+  }
+
+  MappingEntry key;
+  SDL_strlcpy(key.guid, guid, sizeof(key.guid));
+
+  int lo = 0;
+  int hi = db->num_entries;
+  while (lo < hi)
+  {
+    int mid = lo + (hi - lo) / 2;
+    int ret = strcmp(db->entries[mid].guid, key.guid);
+    if (ret == 0)
+    {
+      return db->entries[mid].line;
+    }
+    else if (ret < 0)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return NULL;
+}
+
+int mapping_guid_variants(SDL_JoystickGUID guid, char variants[MAPPING_GUID_VARIANTS][MAPPING_GUID_LENGTH + 1])
+{
+  char str[MAPPING_GUID_LENGTH + 1];
+  SDL_JoystickGetGUIDString(guid, str, sizeof(str));
+
+  int count = 0;
+  SDL_strlcpy(variants[count++], str, MAPPING_GUID_LENGTH + 1);
+
+  // the CRC of the device name, mappings usually have none
+  if (strncmp(str + GUID_CRC_OFFSET, "0000", 4) != 0)
+  {
+    memcpy(str + GUID_CRC_OFFSET, "0000", 4);
+    SDL_strlcpy(variants[count++], str, MAPPING_GUID_LENGTH + 1);
+  }
+
+  // GUIDs made of bus, vendor, product and version have zeros between
+  // those, the version only counts when there is a mapping for it
+  if (strncmp(str + 12, "0000", 4) == 0 && strncmp(str + 20, "0000", 4) == 0 &&
+      strncmp(str + GUID_VERSION_OFFSET, "0000", 4) != 0)
+  {
+    int num = count;
+    for(int i = 0; i < num; ++i)
+    {
+      SDL_strlcpy(variants[count], variants[i], MAPPING_GUID_LENGTH + 1);
+      memcpy(variants[count] + GUID_VERSION_OFFSET, "0000", 4);
+      count += 1;
+    }
+  }
+
+  return count;
+}
+
+const char* mapping_db_find(const MappingDB* db, SDL_JoystickGUID guid)
+{
+  char variants[MAPPING_GUID_VARIANTS][MAPPING_GUID_LENGTH + 1];
+  int count = mapping_guid_variants(guid, variants);
+  for(int i = 0; i < count; ++i)
+  {
+    const char* line = mapping_db_find_exact(db, variants[i]);
+    if (line)
+    {
+      return line;
+    }
+  }
+  return NULL;
+}
+
+int mapping_db_add_device(MappingDB* db, int device_index)
+{
+  char variants[MAPPING_GUID_VARIANTS][MAPPING_GUID_LENGTH + 1];
+  int count = mapping_guid_variants(SDL_JoystickGetDeviceGUID(device_index), variants);
+
+  // all of them, SDL picks the best match itself
+  int added = 0;
+  for(int i = 0; i < count; ++i)
+  {
+    const char* line = mapping_db_find_exact(db, variants[i]);
+    if (line && SDL_GameControllerAddMapping(line) == 1)
+    {
+      added += 1;
+    }
+  }
+
+  db->registered += added;
+  return added;
+}
+
+int mapping_db_add_present(MappingDB* db)
+{
+  int added = 0;
+  int num_joysticks = SDL_NumJoysticks();
+  for(int device_index = 0; device_index < num_joysticks; ++device_index)
+  {
+    added += mapping_db_add_device(db, device_index);
+  }
+  return added;
+}
+
+static int SDLCALL mapping_db_filter(void* userdata, SDL_Event* event)
+{
+  if (event->type == SDL_JOYDEVICEADDED)
+  {
+    mapping_db_add_device(userdata, event->jdevice.which);
+  }
+  return 1;
+}
+
+static Uint16 guid_word(SDL_JoystickGUID guid, int offset)
+{
+  return (Uint16)(guid.data[offset] | (guid.data[offset + 1] << 8));
+}
+
+void mapping_lookup(MappingLookup* lookup, SDL_JoystickGUID guid, const MappingDB* dbs, int num_dbs)
+{
+  memset(lookup, 0, sizeof(*lookup));
+  SDL_JoystickGetGUIDString(guid, lookup->guid, sizeof(lookup->guid));
+
+  // bus, CRC, vendor, 0, product, 0, version, driver and data, the
+  // layout SDL uses for all GUIDs of real devices
+  lookup->bus = guid_word(guid, 0);
+  lookup->crc = guid_word(guid, 2);
+  if (guid_word(guid, 6) == 0 && guid_word(guid, 10) == 0)
+  {
+    lookup->has_ids = 1;
+    lookup->vendor = guid_word(guid, 4);
+    lookup->product = guid_word(guid, 8);
+    lookup->version = guid_word(guid, 12);
+  }
+
+  // the best matching GUID wins, for the same GUID the first of dbs
+  char variants[MAPPING_GUID_VARIANTS][MAPPING_GUID_LENGTH + 1];
+  int count = mapping_guid_variants(guid, variants);
+  for(int i = 0; i < count && !lookup->mapping; ++i)
+  {
+    for(int j = 0; j < num_dbs && !lookup->mapping; ++j)
+    {
+      lookup->mapping = mapping_db_find_exact(&dbs[j], variants[i]);
+      lookup->source = dbs[j].source;
+    }
+  }
+
+  if (!lookup->mapping)
+  {
+    lookup->source = NULL;
+  }
+}
+
+static const char* bus_name(Uint16 bus)
+{
+  switch(bus)
+  {
+    case BUS_USB:
+      return "USB";
+
+    case BUS_BLUETOOTH:
+      return "Bluetooth";
+
+    case BUS_VIRTUAL:
+      return "virtual";
+
+    default:
+      return "unknown";
+  }
+}
+
+static void print_json_str(FILE* out, const char* str, size_t len)
+{
+  fputc('"', out);
+  for(const unsigned char* p = (const unsigned char*)str; p < (const unsigned char*)str + len; ++p)
+  {
+    if (*p == '"' || *p == '\\')
+    {
+      fprintf(out, "\\%c", *p);
+    }
+    else if (*p < 0x20)
+    {
+      fprintf(out, "\\u%04x", *p);
+    }
+    else
+    {
+      fputc(*p, out);
+    }
+  }
+  fputc('"', out);
+}
+
+static void print_csv_str(FILE* out, const char* str, size_t len)
+{
+  fputc('"', out);
+  for(size_t i = 0; i < len; ++i)
+  {
+    if (str[i] == '"')
+    {
+      fputc('"', out);
+    }
+    fputc(str[i], out);
+  }
+  fputc('"', out);
+}
+
+void mapping_lookup_print(const MappingLookup* lookup, OutputFormat format, int header, FILE* out)
+{
+  // the name is the second field of the mapping
+  const char* name = "";
+  size_t name_len = 0;
+  if (lookup->mapping)
+  {
+    const char* comma = strchr(lookup->mapping, ',');
+    if (comma)
+    {
+      name = comma + 1;
+      const char* end = strchr(name, ',');
+      name_len = end ? (size_t)(end - name) : strlen(name);
+    }
+  }
+
+  switch(format)
+  {
+    case OUTPUT_TEXT:
+      fprintf(out, "GUID:     %s\n", lookup->guid);
+      fprintf(out, "Bus:      0x%04x (%s)\n", lookup->bus, bus_name(lookup->bus));
+      if (lookup->has_ids)
+      {
+        fprintf(out, "Vendor:   0x%04x\n", lookup->vendor);
+        fprintf(out, "Product:  0x%04x\n", lookup->product);
+        fprintf(out, "Version:  0x%04x\n", lookup->version);
+      }
+      fprintf(out, "CRC:      0x%04x\n", lookup->crc);
+      if (!lookup->mapping)
+      {
+        fprintf(out, "Mapping:  missing\n");
+      }
+      else
+      {
+        fprintf(out, "Name:     '%.*s'\n", (int)name_len, name);
+        fprintf(out, "Source:   %s\n", lookup->source);
+        fprintf(out, "Mapping:  '%s'\n", lookup->mapping);
+      }
+      fprintf(out, "\n");
+      break;
+
+    case OUTPUT_CSV:
+      if (header)
+      {
+        fprintf(out, "guid,bus,vendor,product,version,crc,name,source,mapping\n");
+      }
+      fprintf(out, "%s,%u,", lookup->guid, lookup->bus);
+      if (lookup->has_ids)
+      {
+        fprintf(out, "%u,%u,%u,", lookup->vendor, lookup->product, lookup->version);
+      }
+      else
+      {
+        fprintf(out, ",,,");
+      }
+      fprintf(out, "%u,", lookup->crc);
+      if (lookup->mapping)
+      {
+        print_csv_str(out, name, name_len);
+        fputc(',', out);
+        print_csv_str(out, lookup->source, strlen(lookup->source));
+        fputc(',', out);
+        print_csv_str(out, lookup->mapping, strlen(lookup->mapping));
+      }
+      else
+      {
+        fprintf(out, ",,");
+      }
+      fprintf(out, "\n");
+      break;
+
+    case OUTPUT_JSONL:
+      fprintf(out, "{\"guid\":\"%s\",\"bus\":%u,", lookup->guid, lookup->bus);
+      if (lookup->has_ids)
+      {
+        fprintf(out, "\"vendor\":%u,\"product\":%u,\"version\":%u,",
+                lookup->vendor, lookup->product, lookup->version);
+      }
+      else
+      {
+        fprintf(out, "\"vendor\":null,\"product\":null,\"version\":null,");
+      }
+      fprintf(out, "\"crc\":%u,", lookup->crc);
+      if (lookup->mapping)
+      {
+        fprintf(out, "\"name\":");
+        print_json_str(out, name, name_len);
+        fprintf(out, ",\"source\":");
+        print_json_str(out, lookup->source, strlen(lookup->source));
+        fprintf(out, ",\"mapping\":");
+        print_json_str(out, lookup->mapping, strlen(lookup->mapping));
+        fprintf(out, "}\n");
+      }
+      else
+      {
+        fprintf(out, "\"name\":null,\"source\":null,\"mapping\":null}\n");
+      }
+      break;
+  }
+}
+
+void mapping_db_watch(MappingDB* db)
+{
+  SDL_SetEventFilter(mapping_db_filter, db);
+}
+
+void mapping_db_unwatch(MappingDB* db)
+{
+  SDL_SetEventFilter(NULL, NULL);
+}
+
+/* EOF */
@@ -0,0 +1,129 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_MAPPINGS_H
+#define HEADER_SDL_JSTEST_MAPPINGS_H
+
+#include <SDL.h>
+#include <stdio.h>
+
+#include "output.h"
+
+// Length of a GUID in hex as printed by SDL_JoystickGetGUIDString()
+#define MAPPING_GUID_LENGTH 32
+
+// Most GUIDs mapping_guid_variants() returns
+#define MAPPING_GUID_VARIANTS 4
+
+typedef struct
+{
+  char guid[MAPPING_GUID_LENGTH + 1];  // lower case hex
+  const char* line;                    // NUL terminated mapping
+} MappingEntry;
+
+// Index of gamecontrollerdb.txt. Registering every mapping of the
+// file with SDL_GameControllerAddMappingsFromFile() parses thousands
+// of them on each start, so the file is only scanned for the GUIDs of
+// the lines that apply to this platform, and the mapping of a device
+// is handed to SDL when the device shows up. As with SDL, lines
+// without a platform field are ignored and the last line for a GUID
+// wins.
+//
+// The index can also come from gamecontrollerdb.bin, the same
+// mappings compiled into a hash table at build time, see
+// mapping_table.h.
+typedef struct
+{
+  char* source;   // file the mappings came from
+  char* data;     // contents of the file, every line NUL terminated
+  MappingEntry* entries;  // sorted by guid
+  struct MappingTable* table;  // instead of data and entries
+  int num_entries;
+  int num_lines;  // mapping lines for any platform
+  int registered; // mappings handed to SDL
+} MappingDB;
+
+// Read and index the mappings in path. Returns 0 on success and -1
+// on error, the error is available from SDL_GetError().
+int mapping_db_load(MappingDB* db, const char* path);
+
+// Use the compiled table in path, same return values
+int mapping_db_load_table(MappingDB* db, const char* path);
+
+// Index mappings given as text, e.g. SDL_GAMECONTROLLERCONFIG, where
+// lines without a platform field count as well
+void mapping_db_load_string(MappingDB* db, const char* source, const char* text);
+
+// Load the mappings from gamecontrollerdb.bin in dir, unless
+// gamecontrollerdb.txt next to it is newer, so an edited text file
+// overrides the table. Same return values.
+int mapping_db_open(MappingDB* db, const char* dir);
+
+void mapping_db_free(MappingDB* db);
+
+// The mapping for guid or NULL. Like SDL a GUID also matches a
+// mapping without the CRC of the name and without the version.
+const char* mapping_db_find(const MappingDB* db, SDL_JoystickGUID guid);
+
+// The mapping filed under exactly guid, a lower case GUID string
+const char* mapping_db_find_exact(const MappingDB* db, const char* guid);
+
+// The GUID strings a mapping for guid might be filed under, from the
+// best to the worst match, returns how many there are
+int mapping_guid_variants(SDL_JoystickGUID guid, char variants[MAPPING_GUID_VARIANTS][MAPPING_GUID_LENGTH + 1]);
+
+// Register the mapping of one device or of all connected devices with
+// SDL, returns the number of mappings that were registered
+int mapping_db_add_device(MappingDB* db, int device_index);
+int mapping_db_add_present(MappingDB* db);
+
+// Register the mappings of devices that get connected later, from an
+// event filter so that the mapping is in place before SDL decides
+// whether the device is a game controller. This takes the single
+// event filter slot of SDL. Setting a filter flushes the event queue,
+// so call it before SDL_Init() to keep the added events of connected
+// devices, db may still be empty then. db has to stay around until
+// mapping_db_unwatch() is called.
+void mapping_db_watch(MappingDB* db);
+void mapping_db_unwatch(MappingDB* db);
+
+// What a GUID tells about its device and the mapping SDL would use
+// for it, for --lookup
+typedef struct
+{
+  char guid[MAPPING_GUID_LENGTH + 1];
+  Uint16 bus;
+  Uint16 crc;
+
+  // only for GUIDs made of vendor, product and version
+  int has_ids;
+  Uint16 vendor;
+  Uint16 product;
+  Uint16 version;
+
+  const char* mapping;  // NULL when there is none
+  const char* source;   // where the mapping came from
+} MappingLookup;
+
+// Look guid up in dbs, which are ordered from the highest precedence
+// to the lowest. The lookup points into the dbs.
+void mapping_lookup(MappingLookup* lookup, SDL_JoystickGUID guid, const MappingDB* dbs, int num_dbs);
+
+void mapping_lookup_print(const MappingLookup* lookup, OutputFormat format, int header, FILE* out);
+
+#endif
+
+/* EOF */
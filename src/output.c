@@ -0,0 +1,588 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "output.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define OUTPUT_BUFFER_SIZE  (64 * 1024)
+#define OUTPUT_MAX_BUFFERS  256
+#define OUTPUT_FLUSH_MS     20
+#define OUTPUT_MAX_LINE     256
+
+typedef struct OutputBuffer
+{
+  struct OutputBuffer* next;
+  size_t fill;
+  char data[OUTPUT_BUFFER_SIZE];
+} OutputBuffer;
+
+struct Output
+{
+  OutputFormat format;
+  FILE* fp;
+
+  SDL_mutex* mutex;
+  SDL_cond* cond;
+  SDL_Thread* thread;
+  int quit;
+
+  // the buffer that is being filled and when its first line went in
+  OutputBuffer* current;
+  Uint32 current_since;
+
+  // full buffers waiting for the writer
+  OutputBuffer* queue_head;
+  OutputBuffer* queue_tail;
+
+  OutputBuffer* free_list;
+  int allocated;
+  Uint64 dropped;
+};
+
+// The decoded fields of an event, shared by the csv and jsonl format
+typedef struct
+{
+  const char* name;
+  Sint32 which;
+  const char* index_key;  // NULL for device events
+  int index;
+  const char* index_name; // controller axis or button name
+  const char* value_key;
+  int value;
+  const char* value2_key; // NULL unless the event has a second value
+  int value2;
+} EventFields;
+
+static char* put_str(char* p, const char* str)
+{
+  while (*str)
+  {
+    *p++ = *str++;
+  }
+  return p;
+}
+
+static char* put_int(char* p, long value)
+{
+  char tmp[24];
+  int len = 0;
+  unsigned long u = value < 0 ? 0ul - (unsigned long)value : (unsigned long)value;
+
+  do
+  {
+    tmp[len++] = (char)('0' + u % 10);
+    u /= 10;
+  }
+  while (u);
+
+  if (value < 0)
+  {
+    *p++ = '-';
+  }
+
+  while (len)
+  {
+    *p++ = tmp[--len];
+  }
+  return p;
+}
+
+static char* put_padded(char* p, const char* str, int width)
+{
+  char* start = p;
+  p = put_str(p, str);
+  while (p - start < width)
+  {
+    *p++ = ' ';
+  }
+  return p;
+}
+
+static const char* controller_axis_name(int axis)
+{
+  const char* name = SDL_GameControllerGetStringForAxis((SDL_GameControllerAxis)axis);
+  return name ? name : "invalid";
+}
+
+static const char* controller_button_name(int button)
+{
+  const char* name = SDL_GameControllerGetStringForButton((SDL_GameControllerButton)button);
+  return name ? name : "invalid";
+}
+
+static int decode_event(const SDL_Event* event, EventFields* f)
+{
+  memset(f, 0, sizeof(*f));
+  switch(event->type)
+  {
+    case SDL_JOYAXISMOTION:
+      f->name = "SDL_JOYAXISMOTION";
+      f->which = event->jaxis.which;
+      f->index_key = "axis";
+      f->index = event->jaxis.axis;
+      f->value_key = "value";
+      f->value = event->jaxis.value;
+      return 1;
+
+    case SDL_JOYBUTTONDOWN:
+    case SDL_JOYBUTTONUP:
+      f->name = event->type == SDL_JOYBUTTONDOWN ? "SDL_JOYBUTTONDOWN" : "SDL_JOYBUTTONUP";
+      f->which = event->jbutton.which;
+      f->index_key = "button";
+      f->index = event->jbutton.button;
+      f->value_key = "state";
+      f->value = event->jbutton.state;
+      return 1;
+
+    case SDL_JOYHATMOTION:
+      f->name = "SDL_JOYHATMOTION";
+      f->which = event->jhat.which;
+      f->index_key = "hat";
+      f->index = event->jhat.hat;
+      f->value_key = "value";
+      f->value = event->jhat.value;
+      return 1;
+
+    case SDL_JOYBALLMOTION:
+      f->name = "SDL_JOYBALLMOTION";
+      f->which = event->jball.which;
+      f->index_key = "ball";
+      f->index = event->jball.ball;
+      f->value_key = "x";
+      f->value = event->jball.xrel;
+      f->value2_key = "y";
+      f->value2 = event->jball.yrel;
+      return 1;
+
+    case SDL_JOYDEVICEADDED:
+    case SDL_JOYDEVICEREMOVED:
+      f->name = event->type == SDL_JOYDEVICEADDED ? "SDL_JOYDEVICEADDED" : "SDL_JOYDEVICEREMOVED";
+      f->which = event->jdevice.which;
+      return 1;
+
+    case SDL_CONTROLLERAXISMOTION:
+      f->name = "SDL_CONTROLLERAXISMOTION";
+      f->which = event->caxis.which;
+      f->index_key = "axis";
+      f->index = event->caxis.axis;
+      f->index_name = controller_axis_name(event->caxis.axis);
+      f->value_key = "value";
+      f->value = event->caxis.value;
+      return 1;
+
+    case SDL_CONTROLLERBUTTONDOWN:
+    case SDL_CONTROLLERBUTTONUP:
+      f->name = event->type == SDL_CONTROLLERBUTTONDOWN ? "SDL_CONTROLLERBUTTONDOWN" : "SDL_CONTROLLERBUTTONUP";
+      f->which = event->cbutton.which;
+      f->index_key = "button";
+      f->index = event->cbutton.button;
+      f->index_name = controller_button_name(event->cbutton.button);
+      f->value_key = "state";
+      f->value = event->cbutton.state;
+      return 1;
+
+    case SDL_CONTROLLERDEVICEADDED:
+      f->name = "SDL_CONTROLLERDEVICEADDED";
+      f->which = event->cdevice.which;
+      return 1;
+
+    case SDL_CONTROLLERDEVICEREMOVED:
+      f->name = "SDL_CONTROLLERDEVICEREMOVED";
+      f->which = event->cdevice.which;
+      return 1;
+
+    case SDL_CONTROLLERDEVICEREMAPPED:
+      f->name = "SDL_CONTROLLERDEVICEREMAPPED";
+      f->which = event->cdevice.which;
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+// Same layout as the printf() calls this replaces
+static char* format_text(char* p, const EventFields* f)
+{
+  p = put_str(p, f->name);
+  if (!f->index_key)
+  {
+    p = put_str(p, " which:");
+    p = put_int(p, f->which);
+  }
+  else if (f->index_name)
+  {
+    if (strcmp(f->name, "SDL_CONTROLLERBUTTONUP") == 0)
+    {
+      p = put_str(p, "  ");
+    }
+    p = put_str(p, " controller: ");
+    p = put_int(p, f->which);
+    p = put_str(p, " ");
+    p = put_str(p, f->index_key);
+    p = put_str(p, ": ");
+    if (strcmp(f->index_key, "axis") == 0)
+    {
+      p = put_padded(p, f->index_name, 12);
+    }
+    else
+    {
+      p = put_str(p, f->index_name);
+    }
+    p = put_str(p, " ");
+    p = put_str(p, f->value_key);
+    p = put_str(p, ": ");
+    p = put_int(p, f->value);
+  }
+  else
+  {
+    p = put_str(p, ": joystick: ");
+    p = put_int(p, f->which);
+    p = put_str(p, " ");
+    p = put_str(p, f->index_key);
+    p = put_str(p, ": ");
+    p = put_int(p, f->index);
+    p = put_str(p, " ");
+    p = put_str(p, f->value_key);
+    p = put_str(p, ": ");
+    p = put_int(p, f->value);
+    if (f->value2_key)
+    {
+      p = put_str(p, " ");
+      p = put_str(p, f->value2_key);
+      p = put_str(p, ": ");
+      p = put_int(p, f->value2);
+    }
+  }
+  *p++ = '\n';
+  return p;
+}
+
+// timestamp,event,which,index,value,value2
+static char* format_csv(char* p, Uint32 timestamp, const EventFields* f)
+{
+  p = put_int(p, (long)timestamp);
+  *p++ = ',';
+  p = put_str(p, f->name);
+  *p++ = ',';
+  p = put_int(p, f->which);
+  *p++ = ',';
+  if (f->index_key)
+  {
+    if (f->index_name)
+    {
+      p = put_str(p, f->index_name);
+    }
+    else
+    {
+      p = put_int(p, f->index);
+    }
+    *p++ = ',';
+    p = put_int(p, f->value);
+  }
+  else
+  {
+    *p++ = ',';
+  }
+  *p++ = ',';
+  if (f->value2_key)
+  {
+    p = put_int(p, f->value2);
+  }
+  *p++ = '\n';
+  return p;
+}
+
+static char* format_jsonl(char* p, Uint32 timestamp, const EventFields* f)
+{
+  p = put_str(p, "{\"timestamp\":");
+  p = put_int(p, (long)timestamp);
+  p = put_str(p, ",\"event\":\"");
+  p = put_str(p, f->name);
+  p = put_str(p, "\",\"which\":");
+  p = put_int(p, f->which);
+  if (f->index_key)
+  {
+    p = put_str(p, ",\"");
+    p = put_str(p, f->index_key);
+    p = put_str(p, "\":");
+    if (f->index_name)
+    {
+      *p++ = '"';
+      p = put_str(p, f->index_name);
+      *p++ = '"';
+    }
+    else
+    {
+      p = put_int(p, f->index);
+    }
+    p = put_str(p, ",\"");
+    p = put_str(p, f->value_key);
+    p = put_str(p, "\":");
+    p = put_int(p, f->value);
+  }
+  if (f->value2_key)
+  {
+    p = put_str(p, ",\"");
+    p = put_str(p, f->value2_key);
+    p = put_str(p, "\":");
+    p = put_int(p, f->value2);
+  }
+  p = put_str(p, "}\n");
+  return p;
+}
+
+// Move the current buffer to the writer queue, called with the mutex held
+static void output_enqueue_current(Output* output)
+{
+  if (output->current && output->current->fill > 0)
+  {
+    output->current->next = NULL;
+    if (output->queue_tail)
+    {
+      output->queue_tail->next = output->current;
+    }
+    else
+    {
+      output->queue_head = output->current;
+    }
+    output->queue_tail = output->current;
+    output->current = NULL;
+    SDL_CondSignal(output->cond);
+  }
+}
+
+// Make room for len bytes in the current buffer, called with the
+// mutex held, returns 0 when all buffers are in use
+static int output_reserve(Output* output, size_t len)
+{
+  if (output->current && output->current->fill + len > OUTPUT_BUFFER_SIZE)
+  {
+    output_enqueue_current(output);
+  }
+
+  if (!output->current)
+  {
+    if (output->free_list)
+    {
+      output->current = output->free_list;
+      output->free_list = output->free_list->next;
+    }
+    else if (output->allocated < OUTPUT_MAX_BUFFERS)
+    {
+      output->current = malloc(sizeof(OutputBuffer));
+      output->allocated += 1;
+    }
+    else
+    {
+      return 0;
+    }
+    output->current->fill = 0;
+  }
+
+  return 1;
+}
+
+static void output_append(Output* output, const char* data, size_t len)
+{
+  SDL_LockMutex(output->mutex);
+  if (!output_reserve(output, len))
+  {
+    output->dropped += 1;
+  }
+  else
+  {
+    if (output->current->fill == 0)
+    {
+      output->current_since = SDL_GetTicks();
+    }
+    memcpy(output->current->data + output->current->fill, data, len);
+    output->current->fill += len;
+  }
+  SDL_UnlockMutex(output->mutex);
+}
+
+static int output_writer(void* userdata)
+{
+  Output* output = userdata;
+
+  SDL_LockMutex(output->mutex);
+  for(;;)
+  {
+    if (!output->queue_head && !output->quit)
+    {
+      SDL_CondWaitTimeout(output->cond, output->mutex, OUTPUT_FLUSH_MS);
+    }
+
+    // don't let a half filled buffer sit around when events are rare
+    if (!output->queue_head && output->current &&
+        (output->quit || SDL_GetTicks() - output->current_since >= OUTPUT_FLUSH_MS))
+    {
+      output_enqueue_current(output);
+    }
+
+    if (!output->queue_head)
+    {
+      if (output->quit)
+      {
+        break;
+      }
+      continue;
+    }
+
+    OutputBuffer* list = output->queue_head;
+    output->queue_head = NULL;
+    output->queue_tail = NULL;
+    SDL_UnlockMutex(output->mutex);
+
+    OutputBuffer* last = list;
+    for(OutputBuffer* buf = list; buf; buf = buf->next)
+    {
+      fwrite(buf->data, 1, buf->fill, output->fp);
+      last = buf;
+    }
+    fflush(output->fp);
+
+    SDL_LockMutex(output->mutex);
+    last->next = output->free_list;
+    output->free_list = list;
+  }
+  SDL_UnlockMutex(output->mutex);
+
+  return 0;
+}
+
+int output_parse_format(const char* str, OutputFormat* format)
+{
+  if (strcmp(str, "text") == 0)
+  {
+    *format = OUTPUT_TEXT;
+    return 1;
+  }
+  else if (strcmp(str, "csv") == 0)
+  {
+    *format = OUTPUT_CSV;
+    return 1;
+  }
+  else if (strcmp(str, "jsonl") == 0)
+  {
+    *format = OUTPUT_JSONL;
+    return 1;
+  }
+  else
+  {
+    return 0;
+  }
+}
+
+Output* output_open(OutputFormat format, FILE* fp)
+{
+  Output* output = calloc(1, sizeof(Output));
+  output->format = format;
+  output->fp = fp;
+  output->mutex = SDL_CreateMutex();
+  output->cond = SDL_CreateCond();
+
+  // whatever was printed before has to come out first
+  fflush(fp);
+
+  if (format == OUTPUT_CSV)
+  {
+    const char* header = "timestamp,event,which,index,value,value2\n";
+    output_append(output, header, strlen(header));
+  }
+
+  output->thread = SDL_CreateThread(output_writer, "output", output);
+  if (!output->thread)
+  {
+    fprintf(stderr, "error: failed to create output thread: %s\n", SDL_GetError());
+    exit(EXIT_FAILURE);
+  }
+
+  return output;
+}
+
+int output_event(Output* output, const SDL_Event* event)
+{
+  EventFields fields;
+  if (!decode_event(event, &fields))
+  {
+    return 0;
+  }
+  else
+  {
+    char line[OUTPUT_MAX_LINE];
+    char* end;
+    switch(output->format)
+    {
+      case OUTPUT_CSV:
+        end = format_csv(line, event->common.timestamp, &fields);
+        break;
+
+      case OUTPUT_JSONL:
+        end = format_jsonl(line, event->common.timestamp, &fields);
+        break;
+
+      case OUTPUT_TEXT:
+      default:
+        end = format_text(line, &fields);
+        break;
+    }
+
+    output_append(output, line, (size_t)(end - line));
+    return 1;
+  }
+}
+
+void output_message(Output* output, const char* text)
+{
+  if (output->format == OUTPUT_TEXT)
+  {
+    output_append(output, text, strlen(text));
+  }
+}
+
+void output_close(Output* output)
+{
+  SDL_LockMutex(output->mutex);
+  output->quit = 1;
+  SDL_CondSignal(output->cond);
+  SDL_UnlockMutex(output->mutex);
+
+  SDL_WaitThread(output->thread, NULL);
+
+  if (output->dropped)
+  {
+    fprintf(stderr, "warning: output couldn't keep up, %llu events were dropped\n",
+            (unsigned long long)output->dropped);
+  }
+
+  while (output->free_list)
+  {
+    OutputBuffer* next = output->free_list->next;
+    free(output->free_list);
+    output->free_list = next;
+  }
+  free(output->current);
+
+  SDL_DestroyCond(output->cond);
+  SDL_DestroyMutex(output->mutex);
+  free(output);
+}
+
+/* EOF */
@@ -0,0 +1,54 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_OUTPUT_H
+#define HEADER_SDL_JSTEST_OUTPUT_H
+
+#include <SDL.h>
+#include <stdio.h>
+
+typedef enum
+{
+  OUTPUT_TEXT,
+  OUTPUT_CSV,
+  OUTPUT_JSONL
+} OutputFormat;
+
+// Parse "text", "csv" or "jsonl", returns 0 on error
+int output_parse_format(const char* str, OutputFormat* format);
+
+// Event printer for --event. Events are formatted into large buffers
+// that a writer thread hands to the file once they are full or older
+// than a few milliseconds, so a slow terminal or pipe never blocks
+// the event loop. When the writer falls behind further than the
+// buffer limit allows, events are dropped and counted instead.
+typedef struct Output Output;
+
+Output* output_open(OutputFormat format, FILE* fp);
+
+// Queue event for printing, returns 0 when the event isn't a
+// joystick or gamecontroller event
+int output_event(Output* output, const SDL_Event* event);
+
+// Queue a line of text, only used for the text format
+void output_message(Output* output, const char* text);
+
+// Write out everything that is queued and stop the writer thread
+void output_close(Output* output);
+
+#endif
+
+/* EOF */
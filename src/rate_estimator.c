@@ -0,0 +1,120 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "rate_estimator.h"
+
+#include <math.h>
+#include <string.h>
+
+#define RATE_WINDOW_MS 1000
+
+void rate_estimator_init(RateEstimator* rate)
+{
+  memset(rate, 0, sizeof(*rate));
+  rate->interval_min = UINT32_MAX;
+}
+
+void rate_estimator_add(RateEstimator* rate, uint32_t timestamp)
+{
+  if (rate->reports == 0)
+  {
+    rate->reports = 1;
+    rate->first_timestamp = timestamp;
+    rate->last_timestamp = timestamp;
+    rate->window_start = timestamp;
+    rate->window_reports = 1;
+  }
+  else if (timestamp != rate->last_timestamp)
+  {
+    uint32_t interval = timestamp - rate->last_timestamp;
+
+    rate->reports += 1;
+    rate->last_timestamp = timestamp;
+
+    double n = (double)(rate->reports - 1);
+    double delta = interval - rate->interval_mean;
+    rate->interval_mean += delta / n;
+    rate->interval_m2 += delta * (interval - rate->interval_mean);
+    if (interval < rate->interval_min) rate->interval_min = interval;
+    if (interval > rate->interval_max) rate->interval_max = interval;
+
+    uint32_t window_length = timestamp - rate->window_start;
+    if (window_length >= RATE_WINDOW_MS)
+    {
+      rate->window_rate = rate->window_reports * 1000.0 / window_length;
+      rate->window_start = timestamp;
+      rate->window_reports = 0;
+    }
+    rate->window_reports += 1;
+  }
+}
+
+double rate_estimator_rate(const RateEstimator* rate)
+{
+  uint32_t duration = rate->last_timestamp - rate->first_timestamp;
+  if (rate->reports < 2 || duration == 0)
+  {
+    return 0.0;
+  }
+  else
+  {
+    return (double)(rate->reports - 1) * 1000.0 / duration;
+  }
+}
+
+double rate_estimator_jitter(const RateEstimator* rate)
+{
+  if (rate->reports < 3)
+  {
+    return 0.0;
+  }
+  else
+  {
+    return sqrt(rate->interval_m2 / (double)(rate->reports - 2));
+  }
+}
+
+double rate_estimator_live_rate(const RateEstimator* rate, uint32_t now)
+{
+  if (rate->reports == 0 || now - rate->last_timestamp > RATE_WINDOW_MS)
+  {
+    return 0.0;
+  }
+  else
+  {
+    return rate->window_rate;
+  }
+}
+
+void rate_estimator_print(const RateEstimator* rate, FILE* out)
+{
+  if (rate->reports < 2)
+  {
+    fprintf(out, "  not enough reports were received\n");
+  }
+  else
+  {
+    fprintf(out, "  Reports:  %llu in %.3f s\n",
+            (unsigned long long)rate->reports,
+            (rate->last_timestamp - rate->first_timestamp) / 1000.0);
+    fprintf(out, "  Rate:     %.1f Hz\n", rate_estimator_rate(rate));
+    fprintf(out, "  Interval: mean %.3f ms, jitter %.3f ms, min %u ms, max %u ms\n",
+            rate->interval_mean, rate_estimator_jitter(rate),
+            (unsigned)rate->interval_min, (unsigned)rate->interval_max);
+  }
+}
+
+/* EOF */
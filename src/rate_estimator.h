@@ -0,0 +1,67 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_RATE_ESTIMATOR_H
+#define HEADER_SDL_JSTEST_RATE_ESTIMATOR_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Estimates the report rate of a device from the millisecond
+// timestamps of its events. All events sharing a timestamp are
+// counted as one report, so rates above 1000Hz can't be told apart
+// and the events have to be pumped at least once per millisecond,
+// as SDL_WaitEvent() and the --wait loop do, for the numbers to be
+// meaningful.
+typedef struct
+{
+  uint64_t reports;
+  uint32_t first_timestamp;
+  uint32_t last_timestamp;
+
+  // running mean and sum of squared deviations of the intervals
+  // between reports (Welford)
+  double interval_mean;
+  double interval_m2;
+  uint32_t interval_min;
+  uint32_t interval_max;
+
+  // reports in the current and in the last completed one second window
+  uint32_t window_start;
+  uint32_t window_reports;
+  double window_rate;
+} RateEstimator;
+
+void rate_estimator_init(RateEstimator* rate);
+
+// Feed the timestamp of an event that came from the device
+void rate_estimator_add(RateEstimator* rate, uint32_t timestamp);
+
+// Average report rate in Hz since the first report
+double rate_estimator_rate(const RateEstimator* rate);
+
+// Standard deviation of the intervals between reports in ms
+double rate_estimator_jitter(const RateEstimator* rate);
+
+// Report rate of the last completed one second window, 0 when the
+// device has been quiet for longer than that
+double rate_estimator_live_rate(const RateEstimator* rate, uint32_t now);
+
+void rate_estimator_print(const RateEstimator* rate, FILE* out);
+
+#endif
+
+/* EOF */
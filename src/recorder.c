@@ -0,0 +1,331 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "recorder.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "byte_order.h"
+
+// events are collected in memory and written out in chunks of this
+// size, a 1kHz device fills it about every 30 seconds
+#define RECORDER_BUFFER_SIZE (1024 * 1024)
+
+struct Recorder
+{
+  char* filename;
+  FILE* fp;
+  int failed;
+
+  Uint64 events;
+  Uint64 bytes;
+
+  size_t fill;
+  Uint8 buffer[RECORDER_BUFFER_SIZE];
+};
+
+static void recorder_flush(Recorder* recorder)
+{
+  if (!recorder->failed && recorder->fill > 0)
+  {
+    if (fwrite(recorder->buffer, 1, recorder->fill, recorder->fp) != recorder->fill)
+    {
+      fprintf(stderr, "error: failed to write to '%s': %s\n", recorder->filename, strerror(errno));
+      recorder->failed = 1;
+    }
+    recorder->bytes += recorder->fill;
+  }
+  recorder->fill = 0;
+}
+
+static void recorder_write(Recorder* recorder, const void* data, size_t len)
+{
+  if (recorder->fill + len > RECORDER_BUFFER_SIZE)
+  {
+    recorder_flush(recorder);
+  }
+
+  if (len > RECORDER_BUFFER_SIZE)
+  {
+    if (!recorder->failed && fwrite(data, 1, len, recorder->fp) != len)
+    {
+      fprintf(stderr, "error: failed to write to '%s': %s\n", recorder->filename, strerror(errno));
+      recorder->failed = 1;
+    }
+    recorder->bytes += len;
+  }
+  else
+  {
+    memcpy(recorder->buffer + recorder->fill, data, len);
+    recorder->fill += len;
+  }
+}
+
+static void recorder_write_string(Recorder* recorder, const char* str)
+{
+  size_t len = str ? strlen(str) : 0;
+  if (len > 0xffff)
+  {
+    len = 0xffff;
+  }
+
+  Uint8 buf[2];
+  put_u16(buf, (Uint16)len);
+  recorder_write(recorder, buf, sizeof(buf));
+  recorder_write(recorder, str, len);
+}
+
+Recorder* recorder_open(const char* filename, SDL_Joystick* joy)
+{
+  FILE* fp = fopen(filename, "wb");
+  if (!fp)
+  {
+    fprintf(stderr, "error: couldn't open '%s' for recording: %s\n", filename, strerror(errno));
+    return NULL;
+  }
+  else
+  {
+    Recorder* recorder = malloc(sizeof(Recorder));
+    recorder->filename = SDL_strdup(filename);
+    recorder->fp = fp;
+    recorder->failed = 0;
+    recorder->events = 0;
+    recorder->bytes = 0;
+    recorder->fill = 0;
+
+    SDL_JoystickGUID guid = SDL_JoystickGetGUID(joy);
+
+    Uint8 buf[8 + 2 + 16 + 4 + 4 * 2];
+    Uint8* p = buf;
+    memcpy(p, RECORD_MAGIC, 8);
+    p += 8;
+    p = put_u16(p, RECORD_VERSION);
+    memcpy(p, guid.data, 16);
+    p += 16;
+    p = put_u32(p, (Uint32)SDL_JoystickInstanceID(joy));
+    p = put_u16(p, (Uint16)SDL_JoystickNumAxes(joy));
+    p = put_u16(p, (Uint16)SDL_JoystickNumButtons(joy));
+    p = put_u16(p, (Uint16)SDL_JoystickNumHats(joy));
+    p = put_u16(p, (Uint16)SDL_JoystickNumBalls(joy));
+    recorder_write(recorder, buf, (size_t)(p - buf));
+
+    recorder_write_string(recorder, SDL_JoystickName(joy));
+
+    char* mapping = SDL_GameControllerMappingForGUID(guid);
+    recorder_write_string(recorder, mapping);
+    SDL_free(mapping);
+
+    return recorder;
+  }
+}
+
+void recorder_add(Recorder* recorder, const SDL_Event* event)
+{
+  Sint32 which;
+  Uint8 index = 0;
+  Sint16 value = 0;
+  Sint16 value2 = 0;
+
+  switch(event->type)
+  {
+    case SDL_JOYAXISMOTION:
+      which = event->jaxis.which;
+      index = event->jaxis.axis;
+      value = event->jaxis.value;
+      break;
+
+    case SDL_JOYBALLMOTION:
+      which = event->jball.which;
+      index = event->jball.ball;
+      value = event->jball.xrel;
+      value2 = event->jball.yrel;
+      break;
+
+    case SDL_JOYHATMOTION:
+      which = event->jhat.which;
+      index = event->jhat.hat;
+      value = event->jhat.value;
+      break;
+
+    case SDL_JOYBUTTONDOWN:
+    case SDL_JOYBUTTONUP:
+      which = event->jbutton.which;
+      index = event->jbutton.button;
+      value = event->jbutton.state;
+      break;
+
+    case SDL_JOYDEVICEADDED:
+    case SDL_JOYDEVICEREMOVED:
+      which = event->jdevice.which;
+      break;
+
+    case SDL_CONTROLLERAXISMOTION:
+      which = event->caxis.which;
+      index = event->caxis.axis;
+      value = event->caxis.value;
+      break;
+
+    case SDL_CONTROLLERBUTTONDOWN:
+    case SDL_CONTROLLERBUTTONUP:
+      which = event->cbutton.which;
+      index = event->cbutton.button;
+      value = event->cbutton.state;
+      break;
+
+    case SDL_CONTROLLERDEVICEADDED:
+    case SDL_CONTROLLERDEVICEREMOVED:
+    case SDL_CONTROLLERDEVICEREMAPPED:
+      which = event->cdevice.which;
+      break;
+
+    default:
+      return;
+  }
+
+  if (recorder->fill + RECORD_EVENT_SIZE > RECORDER_BUFFER_SIZE)
+  {
+    recorder_flush(recorder);
+  }
+
+  Uint8* p = recorder->buffer + recorder->fill;
+  p = put_u32(p, event->common.timestamp);
+  p = put_u32(p, (Uint32)which);
+  p = put_u16(p, (Uint16)event->type);
+  p[0] = index;
+  p[1] = 0;
+  p += 2;
+  p = put_u16(p, (Uint16)value);
+  put_u16(p, (Uint16)value2);
+
+  recorder->fill += RECORD_EVENT_SIZE;
+  recorder->events += 1;
+}
+
+void recorder_close(Recorder* recorder)
+{
+  recorder_flush(recorder);
+  if (fclose(recorder->fp) != 0 && !recorder->failed)
+  {
+    fprintf(stderr, "error: failed to write to '%s': %s\n", recorder->filename, strerror(errno));
+    recorder->failed = 1;
+  }
+
+  fprintf(stderr, "Recorded %llu events (%llu bytes) to '%s'%s\n",
+          (unsigned long long)recorder->events,
+          (unsigned long long)recorder->bytes,
+          recorder->filename,
+          recorder->failed ? ", the file is incomplete" : "");
+
+  SDL_free(recorder->filename);
+  free(recorder);
+}
+
+static char* read_string(FILE* fp)
+{
+  Uint8 buf[2];
+  if (fread(buf, 1, sizeof(buf), fp) != sizeof(buf))
+  {
+    return NULL;
+  }
+  else
+  {
+    size_t len = get_u16(buf);
+    char* str = malloc(len + 1);
+    if (fread(str, 1, len, fp) != len)
+    {
+      free(str);
+      return NULL;
+    }
+    str[len] = '\0';
+    return str;
+  }
+}
+
+int record_read_header(FILE* fp, RecordHeader* header)
+{
+  Uint8 buf[8 + 2 + 16 + 4 + 4 * 2];
+  if (fread(buf, 1, sizeof(buf), fp) != sizeof(buf) ||
+      memcmp(buf, RECORD_MAGIC, 8) != 0)
+  {
+    fprintf(stderr, "error: not a sdl2-jstest recording\n");
+    return -1;
+  }
+  else if (get_u16(buf + 8) != RECORD_VERSION)
+  {
+    fprintf(stderr, "error: unsupported recording version %d\n", get_u16(buf + 8));
+    return -1;
+  }
+  else
+  {
+    const Uint8* p = buf + 10;
+    memcpy(header->guid.data, p, 16);
+    p += 16;
+    header->instance_id = (SDL_JoystickID)get_u32(p);
+    p += 4;
+    header->num_axes    = get_u16(p + 0);
+    header->num_buttons = get_u16(p + 2);
+    header->num_hats    = get_u16(p + 4);
+    header->num_balls   = get_u16(p + 6);
+
+    header->name = read_string(fp);
+    header->mapping = header->name ? read_string(fp) : NULL;
+    if (!header->mapping)
+    {
+      fprintf(stderr, "error: truncated recording header\n");
+      record_header_free(header);
+      return -1;
+    }
+
+    if (header->mapping[0] == '\0')
+    {
+      free(header->mapping);
+      header->mapping = NULL;
+    }
+    return 0;
+  }
+}
+
+void record_header_free(RecordHeader* header)
+{
+  free(header->name);
+  free(header->mapping);
+  header->name = NULL;
+  header->mapping = NULL;
+}
+
+int record_read_event(FILE* fp, RecordEvent* event)
+{
+  Uint8 buf[RECORD_EVENT_SIZE];
+  if (fread(buf, 1, sizeof(buf), fp) != sizeof(buf))
+  {
+    return 0;
+  }
+  else
+  {
+    event->timestamp = get_u32(buf + 0);
+    event->which     = (Sint32)get_u32(buf + 4);
+    event->type      = get_u16(buf + 8);
+    event->index     = buf[10];
+    event->value     = (Sint16)get_u16(buf + 12);
+    event->value2    = (Sint16)get_u16(buf + 14);
+    return 1;
+  }
+}
+
+/* EOF */
@@ -0,0 +1,93 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_RECORDER_H
+#define HEADER_SDL_JSTEST_RECORDER_H
+
+#include <SDL.h>
+#include <stdio.h>
+
+// Binary event log, all numbers are little endian:
+//
+//   header:
+//     char[8]   magic "SDLJSREC"
+//     Uint16    format version
+//     Uint8[16] joystick GUID
+//     Sint32    joystick instance id
+//     Uint16    number of axes, buttons, hats and balls
+//     Uint16    length of the name, followed by the name
+//     Uint16    length of the mapping, followed by the mapping
+//               (0 when the joystick isn't a gamecontroller)
+//
+//   followed by RECORD_EVENT_SIZE byte events:
+//     Uint32    timestamp in ms
+//     Sint32    instance id (device index for *DEVICEADDED)
+//     Uint16    SDL event type
+//     Uint8     axis, button, hat or ball
+//     Uint8     unused
+//     Sint16    axis value, button state, hat value or ball xrel
+//     Sint16    ball yrel
+#define RECORD_MAGIC      "SDLJSREC"
+#define RECORD_VERSION    1
+#define RECORD_EVENT_SIZE 16
+
+typedef struct
+{
+  SDL_JoystickGUID guid;
+  SDL_JoystickID instance_id;
+  int num_axes;
+  int num_buttons;
+  int num_hats;
+  int num_balls;
+  char* name;
+  char* mapping; // NULL when there is none
+} RecordHeader;
+
+typedef struct
+{
+  Uint32 timestamp;
+  Sint32 which;
+  Uint32 type;
+  Uint8  index;
+  Sint16 value;
+  Sint16 value2;
+} RecordEvent;
+
+typedef struct Recorder Recorder;
+
+// Create filename and write the header describing joy, returns NULL
+// on error
+Recorder* recorder_open(const char* filename, SDL_Joystick* joy);
+
+// Append event to the log if it is a joystick or gamecontroller event
+void recorder_add(Recorder* recorder, const SDL_Event* event);
+
+// Flush and close the log and print how much was written
+void recorder_close(Recorder* recorder);
+
+// Read the header of a log opened with fopen(), returns 0 on success
+// and -1 when the file isn't a valid log. The strings in header have
+// to be released with record_header_free().
+int record_read_header(FILE* fp, RecordHeader* header);
+void record_header_free(RecordHeader* header);
+
+// Read the next event of the log, returns 1 on success and 0 at the
+// end of the file
+int record_read_event(FILE* fp, RecordEvent* event);
+
+#endif
+
+/* EOF */
@@ -0,0 +1,365 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "replay.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#include "joystick_state.h"
+#include "recorder.h"
+
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+
+struct Replay
+{
+  char* filename;
+  FILE* fp;
+  RecordHeader header;
+  double speed;
+
+  int device_index;
+  SDL_JoystickID instance_id;
+  SDL_Joystick* joy;
+
+  RecordEvent next;
+  int has_next;
+
+  int started;
+  Uint64 start_counter;
+  Uint32 first_timestamp;
+
+  // number of the Update call in which a control was last changed
+  Uint32 serial;
+  Uint32* axis_serial;
+  Uint32* button_serial;
+  Uint32* hat_serial;
+
+  Uint64 replayed;
+  Uint64 skipped;
+  int done;
+  Uint64 end_counter;
+};
+
+// SDL2 GUIDs carry the USB vendor and product id in bytes 4 and 8,
+// when the bytes after them are zero
+static void guid_vendor_product(SDL_JoystickGUID guid, Uint16* vendor, Uint16* product)
+{
+  const Uint8* d = guid.data;
+  if (d[6] == 0 && d[7] == 0 && d[10] == 0 && d[11] == 0)
+  {
+    *vendor  = (Uint16)(d[4] | (d[5] << 8));
+    *product = (Uint16)(d[8] | (d[9] << 8));
+  }
+  else
+  {
+    *vendor = 0;
+    *product = 0;
+  }
+}
+
+static void replay_advance(Replay* replay)
+{
+  replay->has_next = record_read_event(replay->fp, &replay->next);
+}
+
+// Returns the serial slot of the control the event changes or NULL
+// when the event can't be replayed
+static Uint32* replay_event_slot(Replay* replay, const RecordEvent* event)
+{
+  if (event->which != replay->header.instance_id)
+  {
+    return NULL;
+  }
+
+  switch(event->type)
+  {
+    case SDL_JOYAXISMOTION:
+      return event->index < replay->header.num_axes ? &replay->axis_serial[event->index] : NULL;
+
+    case SDL_JOYBUTTONDOWN:
+    case SDL_JOYBUTTONUP:
+      return event->index < replay->header.num_buttons ? &replay->button_serial[event->index] : NULL;
+
+    case SDL_JOYHATMOTION:
+      return event->index < replay->header.num_hats ? &replay->hat_serial[event->index] : NULL;
+
+    default:
+      return NULL;
+  }
+}
+
+static void replay_apply(Replay* replay, const RecordEvent* event)
+{
+  switch(event->type)
+  {
+    case SDL_JOYAXISMOTION:
+      SDL_JoystickSetVirtualAxis(replay->joy, event->index, event->value);
+      break;
+
+    case SDL_JOYBUTTONDOWN:
+    case SDL_JOYBUTTONUP:
+      SDL_JoystickSetVirtualButton(replay->joy, event->index, (Uint8)event->value);
+      break;
+
+    case SDL_JOYHATMOTION:
+      SDL_JoystickSetVirtualHat(replay->joy, event->index, (Uint8)event->value);
+      break;
+  }
+}
+
+static void replay_update(void* userdata)
+{
+  Replay* replay = userdata;
+
+  if (!replay->joy || replay->done)
+  {
+    return;
+  }
+
+  Uint64 now = SDL_GetPerformanceCounter();
+  if (!replay->started)
+  {
+    replay->started = 1;
+    replay->start_counter = now;
+    replay->first_timestamp = replay->next.timestamp;
+  }
+
+  double elapsed_ms = (double)(now - replay->start_counter) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+  replay->serial += 1;
+  while (replay->has_next)
+  {
+    if (replay->speed > 0.0 &&
+        (double)(replay->next.timestamp - replay->first_timestamp) > elapsed_ms * replay->speed)
+    {
+      break;
+    }
+
+    Uint32* slot = replay_event_slot(replay, &replay->next);
+    if (!slot)
+    {
+      // gamecontroller events are generated again by SDL from the
+      // joystick events, only balls are lost
+      if (replay->next.type == SDL_JOYBALLMOTION)
+      {
+        replay->skipped += 1;
+      }
+    }
+    else if (*slot == replay->serial)
+    {
+      // the control already changed in this update, SDL would only
+      // report the last value, so leave it for the next one
+      break;
+    }
+    else
+    {
+      *slot = replay->serial;
+      replay_apply(replay, &replay->next);
+      replay->replayed += 1;
+    }
+
+    replay_advance(replay);
+  }
+
+  if (!replay->has_next)
+  {
+    replay->done = 1;
+    replay->end_counter = now;
+
+    // let the mode that consumes the replay exit once it has seen
+    // the last events
+    SDL_Event event;
+    memset(&event, 0, sizeof(event));
+    event.type = SDL_QUIT;
+    SDL_PushEvent(&event);
+  }
+}
+
+// Build a mapping for the virtual joystick from the recorded one by
+// replacing the GUID in front of it
+static void replay_add_mapping(Replay* replay)
+{
+  const char* rest = strchr(replay->header.mapping, ',');
+  if (rest)
+  {
+    char guid_str[33];
+    SDL_JoystickGetGUIDString(SDL_JoystickGetDeviceGUID(replay->device_index), guid_str, sizeof(guid_str));
+
+    size_t len = strlen(guid_str) + strlen(rest) + 1;
+    char* mapping = malloc(len);
+    snprintf(mapping, len, "%s%s", guid_str, rest);
+    if (SDL_GameControllerAddMapping(mapping) < 0)
+    {
+      fprintf(stderr, "warning: failed to add the recorded mapping: %s\n", SDL_GetError());
+    }
+    free(mapping);
+  }
+}
+
+Replay* replay_open(const char* filename, double speed)
+{
+  FILE* fp = fopen(filename, "rb");
+  if (!fp)
+  {
+    fprintf(stderr, "error: couldn't open '%s': %s\n", filename, strerror(errno));
+    return NULL;
+  }
+
+  Replay* replay = calloc(1, sizeof(Replay));
+  replay->filename = SDL_strdup(filename);
+  replay->fp = fp;
+  replay->speed = speed;
+  replay->device_index = -1;
+
+  setvbuf(fp, NULL, _IOFBF, 1024 * 1024);
+
+  if (record_read_header(fp, &replay->header) < 0)
+  {
+    fclose(fp);
+    SDL_free(replay->filename);
+    free(replay);
+    return NULL;
+  }
+
+  replay->axis_serial   = calloc((size_t)replay->header.num_axes + 1,    sizeof(Uint32));
+  replay->button_serial = calloc((size_t)replay->header.num_buttons + 1, sizeof(Uint32));
+  replay->hat_serial    = calloc((size_t)replay->header.num_hats + 1,    sizeof(Uint32));
+
+  Uint16 vendor;
+  Uint16 product;
+  guid_vendor_product(replay->header.guid, &vendor, &product);
+
+  SDL_VirtualJoystickDesc desc;
+  memset(&desc, 0, sizeof(desc));
+  desc.version = SDL_VIRTUAL_JOYSTICK_DESC_VERSION;
+  desc.type = (Uint16)(replay->header.mapping ? SDL_JOYSTICK_TYPE_GAMECONTROLLER : SDL_JOYSTICK_TYPE_UNKNOWN);
+  desc.naxes = (Uint16)replay->header.num_axes;
+  desc.nbuttons = (Uint16)replay->header.num_buttons;
+  desc.nhats = (Uint16)replay->header.num_hats;
+  desc.vendor_id = vendor;
+  desc.product_id = product;
+  desc.name = replay->header.name;
+  desc.userdata = replay;
+  desc.Update = replay_update;
+
+  replay->device_index = SDL_JoystickAttachVirtualEx(&desc);
+  if (replay->device_index < 0)
+  {
+    fprintf(stderr, "error: couldn't attach virtual joystick: %s\n", SDL_GetError());
+    replay->joy = NULL;
+    replay_close(replay);
+    return NULL;
+  }
+  replay->instance_id = SDL_JoystickGetDeviceInstanceID(replay->device_index);
+
+  if (replay->header.mapping)
+  {
+    replay_add_mapping(replay);
+  }
+
+  replay_advance(replay);
+
+  // the replay keeps its own handle open, as the virtual joystick
+  // can only be fed through one
+  replay->joy = SDL_JoystickOpen(replay->device_index);
+  if (!replay->joy)
+  {
+    fprintf(stderr, "error: couldn't open virtual joystick: %s\n", SDL_GetError());
+    replay_close(replay);
+    return NULL;
+  }
+
+  fprintf(stderr, "Replaying '%s' (%s) as joystick %d\n",
+          filename, replay->header.name, replay->device_index);
+
+  return replay;
+}
+
+int replay_device_index(const Replay* replay)
+{
+  return replay->device_index;
+}
+
+void replay_close(Replay* replay)
+{
+  if (replay->joy)
+  {
+    if (replay->started)
+    {
+      Uint64 end = replay->end_counter ? replay->end_counter : SDL_GetPerformanceCounter();
+      double seconds = (double)(end - replay->start_counter) / (double)SDL_GetPerformanceFrequency();
+      fprintf(stderr, "Replayed %llu events in %.3f s (%.0f events/s)%s\n",
+              (unsigned long long)replay->replayed, seconds,
+              seconds > 0.0 ? (double)replay->replayed / seconds : 0.0,
+              replay->done ? "" : ", interrupted");
+      if (replay->skipped)
+      {
+        fprintf(stderr, "Skipped %llu events that a virtual joystick can't replay\n",
+                (unsigned long long)replay->skipped);
+      }
+    }
+    SDL_JoystickClose(replay->joy);
+  }
+
+  if (replay->device_index >= 0)
+  {
+    // joysticks that got unplugged during the replay shift the index
+    int device_index = joystick_device_index(replay->instance_id);
+    if (device_index >= 0)
+    {
+      SDL_JoystickDetachVirtual(device_index);
+    }
+  }
+
+  free(replay->hat_serial);
+  free(replay->button_serial);
+  free(replay->axis_serial);
+  record_header_free(&replay->header);
+  fclose(replay->fp);
+  SDL_free(replay->filename);
+  free(replay);
+}
+
+#else
+
+struct Replay
+{
+  int device_index;
+};
+
+Replay* replay_open(const char* filename, double speed)
+{
+  fprintf(stderr, "error: --replay requires SDL 2.24.0 or newer\n");
+  return NULL;
+}
+
+int replay_device_index(const Replay* replay)
+{
+  return replay->device_index;
+}
+
+void replay_close(Replay* replay)
+{
+}
+
+#endif
+
+/* EOF */
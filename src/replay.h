@@ -0,0 +1,43 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_REPLAY_H
+#define HEADER_SDL_JSTEST_REPLAY_H
+
+// Plays a log written by --record back through an SDL virtual
+// joystick, so that all modes see it like a real device. The events
+// are applied from the Update callback of the virtual joystick, that
+// is whenever SDL pumps events, and the replay starts with the first
+// pump. A control is never changed twice within one pump, so every
+// recorded axis, button and hat event comes out of SDL again, no
+// matter how fast the replay runs. Ball events can't be replayed as
+// virtual joysticks have no balls.
+typedef struct Replay Replay;
+
+// Attach a virtual joystick for the recording in filename. speed
+// scales the original timing, 0 replays as fast as possible. Returns
+// NULL on error.
+Replay* replay_open(const char* filename, double speed);
+
+// Device index of the virtual joystick
+int replay_device_index(const Replay* replay);
+
+// Detach the virtual joystick and print how many events were replayed
+void replay_close(Replay* replay);
+
+#endif
+
+/* EOF */
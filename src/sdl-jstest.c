@@ -23,24 +23,21 @@
 
 #include <SDL.h>
 
+#include "loop_stats.h"
+#include "widgets.h"
+
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #define NOGDI
 #  include <windows.h>
 #endif
 
-void print_bar(int pos, int len)
+// Options that modify how a mode runs, they can be given anywhere on
+// the command line and are removed before the mode is dispatched
+typedef struct
 {
-  addch('[');
-  for(int i = 0; i < len; ++i)
-  {
-    if (i == pos)
-      addch('#');
-    else
-      addch(' ');
-  }
-  addch(']');
-}
+  int wait;
+} Options;
 
 int str2int(const char* str, int* val)
 {
@@ -93,9 +90,32 @@ void print_help(const char* prg)
   printf("  --test  JOYNUM     Display a graphical representation of the current joystick state\n");
   printf("  --event JOYNUM     Display the events that are received from the joystick\n");
   printf("\n");
+  printf("Test Options:\n");
+  printf("  --wait             Sleep on the terminal between joystick updates instead\n"
+         "                     of polling every 10ms\n");
+  printf("\n");
   printf("Examples:\n");
   printf("  %s --list\n", prg);
   printf("  %s --test 1\n", prg);
+  printf("  %s --test 1 --wait\n", prg);
+}
+
+int extract_options(int argc, char** argv, Options* opts)
+{
+  int out = 1;
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "--wait") == 0)
+    {
+      opts->wait = 1;
+    }
+    else
+    {
+      argv[out++] = argv[i];
+    }
+  }
+  argv[out] = NULL;
+  return out;
 }
 
 int main(int argc, char** argv)
@@ -109,6 +129,9 @@ int main(int argc, char** argv)
   freopen_s(&fp, "CONOUT$", "w", stderr);
 #endif
 
+  Options opts = { 0 };
+  argc = extract_options(argc, argv, &opts);
+
   if (argc == 1)
   {
     print_help(argv[0]);
@@ -215,15 +238,37 @@ int main(int argc, char** argv)
         Uint8*  hats    = calloc((size_t)num_hats,    sizeof(Uint8));
         Sint16* balls   = calloc((size_t)num_balls,   2*sizeof(Sint16));
 
+        Widgets widgets;
+        widgets_init(&widgets);
+
+        const char* loop_mode = opts.wait ? "wait" : "poll";
+        LoopStats stats;
+        loop_stats_init(&stats, SDL_GetTicks());
+        int timeout = WAIT_TIMEOUT_MIN;
+
         int quit = 0;
         SDL_Event event;
         bool something_new = TRUE;
         while(!quit)
         {
-          SDL_Delay(10);
+          if (opts.wait)
+          {
+            wait_for_terminal(timeout);
+          }
+          else
+          {
+            SDL_Delay(10);
+          }
+
+          if (loop_stats_wakeup(&stats, SDL_GetTicks()))
+          {
+            something_new = TRUE;
+          }
 
+          bool got_event = FALSE;
           while (SDL_PollEvent(&event)) {
             something_new = TRUE;
+            got_event = TRUE;
             switch(event.type)
             {
               case SDL_JOYAXISMOTION:
@@ -259,10 +304,20 @@ int main(int argc, char** argv)
             }
           }
 
+          if (got_event)
+          {
+            timeout = WAIT_TIMEOUT_MIN;
+          }
+          else if (timeout < WAIT_TIMEOUT_MAX)
+          {
+            timeout = timeout * 2 < WAIT_TIMEOUT_MAX ? timeout * 2 : WAIT_TIMEOUT_MAX;
+          }
+
           if (something_new)
           {
             //clear();
             move(0,0);
+            widgets_resize(&widgets, COLS - 20);
 
             printw("Joystick Name:   '%s'\n", SDL_JoystickName(joy_idx));
             printw("Joystick Number: %d\n", joy_idx);
@@ -271,9 +326,8 @@ int main(int argc, char** argv)
             printw("Axes %2d:\n", num_axes);
             for(int i = 0; i < num_axes; ++i)
             {
-              int len = COLS - 20;
               printw("  %2d: %6d  ", i, axes[i]);
-              print_bar((axes[i] + 32767) * (len-1) / 65534, len);
+              widget_bar(stdscr, &widgets, axes[i]);
               addch('\n');
             }
             printw("\n");
@@ -289,31 +343,7 @@ int main(int argc, char** argv)
             for(int i = 0; i < num_hats; ++i)
             {
               printw("  %2d: value: %d\n", i, hats[i]);
-              printw("  +-----+  up:    %c\n"
-                     "  |%c %c %c|  down:  %c\n"
-                     "  |%c %c %c|  left:  %c\n"
-                     "  |%c %c %c|  right: %c\n"
-                     "  +-----+\n",
-
-                     (hats[i] & SDL_HAT_UP)?'1':'0',
-
-                     ((hats[i] & SDL_HAT_UP) && (hats[i] & SDL_HAT_LEFT)) ? 'O' : ' ',
-                     ((hats[i] & SDL_HAT_UP) && !(hats[i] & (SDL_HAT_LEFT | SDL_HAT_RIGHT))) ? 'O' : ' ',
-                     ((hats[i] & SDL_HAT_UP) && (hats[i] & SDL_HAT_RIGHT)) ? 'O' : ' ',
-
-                     (hats[i] & SDL_HAT_DOWN)?'1':'0',
-
-                     (!(hats[i] & (SDL_HAT_UP | SDL_HAT_DOWN)) && (hats[i] & SDL_HAT_LEFT)) ? 'O' : ' ',
-                     (!(hats[i] & (SDL_HAT_UP | SDL_HAT_DOWN)) && !(hats[i] & (SDL_HAT_LEFT | SDL_HAT_RIGHT))) ? 'O' : ' ',
-                     (!(hats[i] & (SDL_HAT_UP | SDL_HAT_DOWN)) && (hats[i] & SDL_HAT_RIGHT)) ? 'O' : ' ',
-
-                     (hats[i] & SDL_HAT_LEFT)?'1':'0',
-
-                     ((hats[i] & SDL_HAT_DOWN) && (hats[i] & SDL_HAT_LEFT)) ? 'O' : ' ',
-                     ((hats[i] & SDL_HAT_DOWN) && !(hats[i] & (SDL_HAT_LEFT | SDL_HAT_RIGHT))) ? 'O' : ' ',
-                     ((hats[i] & SDL_HAT_DOWN) && (hats[i] & SDL_HAT_RIGHT)) ? 'O' : ' ',
-
-                     (hats[i] & SDL_HAT_RIGHT)?'1':'0');
+              widget_hat(stdscr, hats[i]);
             }
             printw("\n");
 
@@ -324,6 +354,8 @@ int main(int argc, char** argv)
             }
             printw("\n");
             printw("\n");
+            printw("Loop: %s, %6.1f wakeups/s, CPU %5.2f%%\n",
+                   loop_mode, stats.wakeups_per_sec, stats.cpu_percent);
             printw("Press Ctrl-c to exit\n");
 
             refresh();
@@ -331,9 +363,13 @@ int main(int argc, char** argv)
             something_new = FALSE;
           }
 
-          if ( getch() == 3 ) // Ctrl-c
+          int ch;
+          while ((ch = getch()) != ERR)
           {
-            quit = 1;
+            if (ch == 3) // Ctrl-c
+            {
+              quit = 1;
+            }
           }
         } // while
 
@@ -341,8 +377,11 @@ int main(int argc, char** argv)
         free(hats);
         free(buttons);
         free(axes);
+        widgets_free(&widgets);
 
         endwin();
+
+        loop_stats_print(&stats, loop_mode, SDL_GetTicks(), stdout);
       }
     }
     else if (argc == 3 && (strcmp(argv[1], "--event") == 0 ||
@@ -16,23 +16,106 @@
 
 #include <SDL.h>
 #include <assert.h>
+#include <ctype.h>
 #include <curses.h>
 #include <errno.h>
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-void print_bar(int pos, int len)
+#include "calibration.h"
+#include "event_ingest.h"
+#include "gamecontroller_view.h"
+#include "generator.h"
+#include "joystick_state.h"
+#include "joystick_view.h"
+#include "latency.h"
+#include "loop_stats.h"
+#include "mappings.h"
+#include "output.h"
+#include "rate_estimator.h"
+#include "recorder.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "stick_gate.h"
+
+// Frame rate cap of the --test view unless --fps is given
+#define DEFAULT_FPS 60
+
+// Longest time the render thread sleeps when nothing changes, it has
+// to look at the keyboard and update the statistics now and then
+#define RENDER_IDLE_TIMEOUT 50
+
+// Status lines below the single joystick view
+#define FOOTER_LINES 3
+
+// Milliseconds between two snapshots of --headless
+#define DEFAULT_INTERVAL 100
+
+// Sticks --stick can show at once
+#define MAX_STICKS 8
+
+// How long --stick watches the axes to find out which belong together
+#define STICK_DETECT_MS 3000
+
+// Size of the polar plot of a stick, cells are about twice as high as
+// they are wide
+#define STICK_PLOT_WIDTH  33
+#define STICK_PLOT_HEIGHT 17
+
+// Presses and gaps between presses shorter than this are bounces
+#define DEFAULT_BOUNCE_MS 20
+
+// Length of the two phases of --calibrate
+#define CALIBRATE_REST_MS  3000
+#define CALIBRATE_SWEEP_MS 10000
+
+// Options that modify how a mode runs, they can be given anywhere on
+// the command line and are removed before the mode is dispatched
+typedef struct
 {
-  addch('[');
-  for(int i = 0; i < len; ++i)
-  {
-    if (i == pos)
-      addch('#');
-    else
-      addch(' ');
-  }
-  addch(']');
+  int wait;
+  const char* record_file;
+  const char* replay_file;
+  const char* virtual_spec;
+  double replay_speed; // 0 for as fast as possible
+  OutputFormat format;
+  int format_set;
+
+  // set by the --latency and --rate modes, which run the --event
+  // loop without printing the events
+  int latency;
+  int rate;
+
+  // frame rate cap of the --test view
+  int fps;
+
+  // --test without curses, dumping the state every interval ms
+  int headless;
+  int interval;
+  int binary;
+
+  // --bounce mode, presses and gaps shorter than bounce_ms count as
+  // bounces there and in the --test view
+  int bounce;
+  int bounce_ms;
+
+  // axis pairs of --stick, detected when num_sticks is 0
+  int stick_axes[2 * MAX_STICKS];
+  int num_sticks;
+
+  // print how long the startup took to stderr
+  int timing;
+
+  // open every device for --list to get the number of axes, buttons,
+  // hats and balls
+  int counts;
+} Options;
+
+// Milliseconds since start, a value of SDL_GetPerformanceCounter()
+static double ms_since(Uint64 start)
+{
+  return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
 }
 
 int str2int(const char* str, int* val)
@@ -61,6 +144,68 @@ int str2int(const char* str, int* val)
   return 1;
 }
 
+int str2double(const char* str, double* val)
+{
+  char* endptr;
+
+  errno = 0;
+  double tmp = strtod(str, &endptr);
+
+  // error or garbage at the end
+  if (errno != 0 || endptr == str || *endptr != '\0') {
+    return 0;
+  }
+
+  *val = tmp;
+  return 1;
+}
+
+// Parse "X,Y[,X,Y...]" into the axis pairs of --sticks
+int str2sticks(const char* str, Options* opts)
+{
+  int count = 0;
+  const char* p = str;
+
+  while (*p)
+  {
+    char* endptr;
+    errno = 0;
+    long axis = strtol(p, &endptr, 10);
+    if (errno != 0 || endptr == p || axis < 0 || axis > INT_MAX ||
+        (*endptr != ',' && *endptr != '\0') ||
+        count >= 2 * MAX_STICKS)
+    {
+      return 0;
+    }
+
+    opts->stick_axes[count++] = (int)axis;
+    p = *endptr ? endptr + 1 : endptr;
+  }
+
+  if (count == 0 || count % 2 != 0)
+  {
+    return 0;
+  }
+
+  opts->num_sticks = count / 2;
+  return 1;
+}
+
+// Parse a JOYNUM argument, "all" gives JOYSTICK_ALL
+int str2joystick(const char* str, int* joy_idx)
+{
+  if (strcmp(str, "all") == 0)
+  {
+    *joy_idx = JOYSTICK_ALL;
+    return 1;
+  }
+  else
+  {
+    // negative numbers would collide with JOYSTICK_ALL
+    return str2int(str, joy_idx) && *joy_idx >= 0;
+  }
+}
+
 void print_joystick_info(int joy_idx, SDL_Joystick* joy, SDL_GameController* gamepad)
 {
   SDL_JoystickGUID guid = SDL_JoystickGetGUID(joy);
@@ -98,20 +243,220 @@ void print_help(const char* prg)
   printf("  -h, --help             Print this help\n");
   printf("  --version              Print version number and exit\n");
   printf("  -l, --list             Search for available joysticks and list their properties\n");
+  printf("  --counts               Open every device for --list to print the number of\n"
+         "                         axes, buttons, hats and balls\n");
   printf("  -t, --test JOYNUM      Display a graphical representation of the current joystick state\n");
   printf("  -g, --gamecontroller IDX\n"
          "                         Test GameController\n");
   printf("  -e, --event JOYNUM     Display the events that are received from the joystick\n");
   printf("  -r, --rumble JOYNUM    Test rumble effects on gamepad JOYNUM\n");
+  printf("  --latency JOYNUM       Measure the delivery latency of joystick events and\n"
+         "                         print a summary on exit\n");
+  printf("  --rate JOYNUM          Measure the report rate and jitter of the joystick\n"
+         "                         and print a summary on exit\n");
+  printf("  --bounce JOYNUM        Count button presses and gaps shorter than --bounce-ms\n"
+         "                         and print a summary on exit\n");
+  printf("  --stick JOYNUM         Draw the gate of every stick and measure its shape\n");
+  printf("  --calibrate JOYNUM     Measure the resting noise and the range of every axis\n"
+         "                         and recommend deadzones\n");
+  printf("  --lookup GUID...       Print the mapping and the device ids of GUIDs without\n"
+         "                         opening any device, '-' reads GUIDs from stdin\n");
+  printf("\n");
+  printf("Test Options:\n");
+  printf("  --wait                 Sleep between joystick updates instead of polling\n"
+         "                         every 10ms\n");
+  printf("  --fps N                Redraw the --test and --gamecontroller view at most\n"
+         "                         N times a second (default: %d)\n", DEFAULT_FPS);
+  printf("  --sticks X,Y[,X,Y...]  Axes that make up the sticks of --stick, detected from\n"
+         "                         the motion when not given\n");
+  printf("  --bounce-ms MS         Shortest press or gap that isn't a bounce (default: %d)\n", DEFAULT_BOUNCE_MS);
+  printf("  --headless             Run --test without curses and write a snapshot of the\n"
+         "                         joystick state to stdout every --interval ms\n");
+  printf("  --interval MS          Time between two --headless snapshots (default: %d)\n", DEFAULT_INTERVAL);
+  printf("  --binary               Write --headless snapshots in a binary format\n");
+  printf("  --record FILE          Write all joystick events of --test or --event to\n"
+         "                         FILE in a compact binary format\n");
+  printf("  --replay FILE          Play a recording back through a virtual joystick,\n"
+         "                         runs --event on it when no other mode is given\n");
+  printf("  --speed N              Scale the replay speed by N\n");
+  printf("  --virtual SPEC         Attach virtual joysticks driven by a timer thread, runs\n"
+         "                         --event on them when no other mode is given. SPEC is\n"
+         "                         a list of count=N,axes=N,buttons=N,hats=N,rate=HZ,\n"
+         "                         wave=sine|square|walk|storm,hz=HZ\n");
+  printf("  --max                  Replay as fast as possible\n");
+  printf("  --format=FORMAT        Print events as 'text' (default), 'csv' or 'jsonl',\n"
+         "                         also switches --gamecontroller to printing events\n"
+         "                         and sets the format of the --calibrate and --lookup\n"
+         "                         reports\n");
+  printf("  --timing               Print how long the startup took to stderr, on its\n"
+         "                         own only start up and exit\n");
+  printf("\n");
+  printf("JOYNUM can be 'all' for --test, --event, --latency, --rate, --bounce and\n"
+         "--calibrate to use every connected joystick at once.\n");
   printf("\n");
   printf("Examples:\n");
   printf("  %s --list\n", prg);
   printf("  %s --test 1\n", prg);
+  printf("  %s --test 1 --wait\n", prg);
+  printf("  %s --test all\n", prg);
+  printf("  %s --test 0 --headless --interval 50\n", prg);
+  printf("  %s --event 0 --record session.rec\n", prg);
+  printf("  %s --replay session.rec --max --test 0\n", prg);
+  printf("  %s --event 0 --format=jsonl > events.jsonl\n", prg);
+  printf("  %s --calibrate all --format=csv > calibration.csv\n", prg);
+  printf("  %s --virtual rate=20000,wave=storm --test all --wait\n", prg);
+  printf("  %s --lookup 030000005e0400008e02000014010000\n", prg);
 }
 
-void list_joysticks(void)
+int extract_options(int argc, char** argv, Options* opts)
 {
+  int out = 1;
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "--wait") == 0)
+    {
+      opts->wait = 1;
+    }
+    else if (strcmp(argv[i], "--record") == 0)
+    {
+      if (i + 1 >= argc)
+      {
+        fprintf(stderr, "Error: --record requires a FILE argument\n");
+        exit(1);
+      }
+      opts->record_file = argv[++i];
+    }
+    else if (strcmp(argv[i], "--virtual") == 0)
+    {
+      if (i + 1 >= argc)
+      {
+        fprintf(stderr, "Error: --virtual requires a SPEC argument\n");
+        exit(1);
+      }
+      opts->virtual_spec = argv[++i];
+    }
+    else if (strcmp(argv[i], "--replay") == 0)
+    {
+      if (i + 1 >= argc)
+      {
+        fprintf(stderr, "Error: --replay requires a FILE argument\n");
+        exit(1);
+      }
+      opts->replay_file = argv[++i];
+    }
+    else if (strcmp(argv[i], "--speed") == 0)
+    {
+      if (i + 1 >= argc || !str2double(argv[i + 1], &opts->replay_speed) || opts->replay_speed <= 0.0)
+      {
+        fprintf(stderr, "Error: --speed requires a positive number\n");
+        exit(1);
+      }
+      i += 1;
+    }
+    else if (strcmp(argv[i], "--max") == 0)
+    {
+      opts->replay_speed = 0.0;
+    }
+    else if (strcmp(argv[i], "--headless") == 0)
+    {
+      opts->headless = 1;
+    }
+    else if (strcmp(argv[i], "--interval") == 0)
+    {
+      if (i + 1 >= argc || !str2int(argv[i + 1], &opts->interval) || opts->interval <= 0)
+      {
+        fprintf(stderr, "Error: --interval requires a positive number of milliseconds\n");
+        exit(1);
+      }
+      i += 1;
+    }
+    else if (strcmp(argv[i], "--binary") == 0)
+    {
+      opts->binary = 1;
+    }
+    else if (strcmp(argv[i], "--timing") == 0)
+    {
+      opts->timing = 1;
+    }
+    else if (strcmp(argv[i], "--counts") == 0)
+    {
+      opts->counts = 1;
+    }
+    else if (strcmp(argv[i], "--sticks") == 0)
+    {
+      if (i + 1 >= argc || !str2sticks(argv[i + 1], opts))
+      {
+        fprintf(stderr, "Error: --sticks requires pairs of axes like '0,1,3,4', up to %d of them\n",
+                MAX_STICKS);
+        exit(1);
+      }
+      i += 1;
+    }
+    else if (strcmp(argv[i], "--bounce-ms") == 0)
+    {
+      if (i + 1 >= argc || !str2int(argv[i + 1], &opts->bounce_ms) ||
+          opts->bounce_ms <= 0 || opts->bounce_ms > BUTTON_BOUNCE_MAX_MS)
+      {
+        fprintf(stderr, "Error: --bounce-ms requires a number between 1 and %d\n", BUTTON_BOUNCE_MAX_MS);
+        exit(1);
+      }
+      i += 1;
+    }
+    else if (strcmp(argv[i], "--fps") == 0)
+    {
+      if (i + 1 >= argc || !str2int(argv[i + 1], &opts->fps) || opts->fps <= 0 || opts->fps > 1000)
+      {
+        fprintf(stderr, "Error: --fps requires a number between 1 and 1000\n");
+        exit(1);
+      }
+      i += 1;
+    }
+    else if (strncmp(argv[i], "--format=", 9) == 0)
+    {
+      if (!output_parse_format(argv[i] + 9, &opts->format))
+      {
+        fprintf(stderr, "Error: unknown format '%s', expected text, csv or jsonl\n", argv[i] + 9);
+        exit(1);
+      }
+      opts->format_set = 1;
+    }
+    else
+    {
+      argv[out++] = argv[i];
+    }
+  }
+  argv[out] = NULL;
+  return out;
+}
+
+static const char* joystick_type_name(SDL_JoystickType type)
+{
+  switch(type)
+  {
+    case SDL_JOYSTICK_TYPE_GAMECONTROLLER: return "gamecontroller";
+    case SDL_JOYSTICK_TYPE_WHEEL:          return "wheel";
+    case SDL_JOYSTICK_TYPE_ARCADE_STICK:   return "arcade stick";
+    case SDL_JOYSTICK_TYPE_FLIGHT_STICK:   return "flight stick";
+    case SDL_JOYSTICK_TYPE_DANCE_PAD:      return "dance pad";
+    case SDL_JOYSTICK_TYPE_GUITAR:         return "guitar";
+    case SDL_JOYSTICK_TYPE_DRUM_KIT:       return "drum kit";
+    case SDL_JOYSTICK_TYPE_ARCADE_PAD:     return "arcade pad";
+    case SDL_JOYSTICK_TYPE_THROTTLE:       return "throttle";
+    default:                               return "unknown";
+  }
+}
+
+// Everything but the counts comes from the device index, as opening a
+// device initializes its driver, which can take tens of milliseconds
+// per device. Devices are only opened for --counts.
+void list_joysticks(const Options* opts)
+{
+  Uint64 start = SDL_GetPerformanceCounter();
   int num_joysticks = SDL_NumJoysticks();
+  double enumerate_ms = ms_since(start);
+  double query_ms = 0.0;
+  double open_ms = 0.0;
+
   if (num_joysticks == 0)
   {
     printf("No joysticks were found\n");
@@ -121,204 +466,843 @@ void list_joysticks(void)
     printf("Found %d joystick(s)\n\n", num_joysticks);
     for(int joy_idx = 0; joy_idx < num_joysticks; ++joy_idx)
     {
-      SDL_Joystick* joy = SDL_JoystickOpen(joy_idx);
-      if (!joy)
+      Uint64 query_start = SDL_GetPerformanceCounter();
+      const char* name = SDL_JoystickNameForIndex(joy_idx);
+      SDL_JoystickGUID guid = SDL_JoystickGetDeviceGUID(joy_idx);
+      SDL_JoystickType type = SDL_JoystickGetDeviceType(joy_idx);
+      Uint16 vendor = SDL_JoystickGetDeviceVendor(joy_idx);
+      Uint16 product = SDL_JoystickGetDeviceProduct(joy_idx);
+      Uint16 version = SDL_JoystickGetDeviceProductVersion(joy_idx);
+      const char* gamecontroller_name = NULL;
+      char* mapping = NULL;
+      if (SDL_IsGameController(joy_idx))
+      {
+        gamecontroller_name = SDL_GameControllerNameForIndex(joy_idx);
+#if SDL_VERSION_ATLEAST(2, 0, 9)
+        mapping = SDL_GameControllerMappingForDeviceIndex(joy_idx);
+#else
+        mapping = SDL_GameControllerMappingForGUID(guid);
+#endif
+      }
+      query_ms += ms_since(query_start);
+
+      char guid_str[1024];
+      SDL_JoystickGetGUIDString(guid, guid_str, sizeof(guid_str));
+
+      printf("Joystick Name:     '%s'\n", name ? name : "");
+      printf("Joystick GUID:     %s\n", guid_str);
+      printf("Joystick Number:   %2d\n", joy_idx);
+      printf("Joystick Type:     %s\n", joystick_type_name(type));
+      printf("Vendor ID:         0x%04x\n", vendor);
+      printf("Product ID:        0x%04x\n", product);
+      printf("Product Version:   0x%04x\n", version);
+
+      if (opts->counts)
+      {
+        Uint64 open_start = SDL_GetPerformanceCounter();
+        SDL_Joystick* joy = SDL_JoystickOpen(joy_idx);
+        if (!joy)
+        {
+          fprintf(stderr, "Unable to open joystick %d\n", joy_idx);
+        }
+        else
+        {
+          int num_axes = SDL_JoystickNumAxes(joy);
+          int num_buttons = SDL_JoystickNumButtons(joy);
+          int num_hats = SDL_JoystickNumHats(joy);
+          int num_balls = SDL_JoystickNumBalls(joy);
+          SDL_JoystickClose(joy);
+          open_ms += ms_since(open_start);
+
+          printf("Number of Axes:    %2d\n", num_axes);
+          printf("Number of Buttons: %2d\n", num_buttons);
+          printf("Number of Hats:    %2d\n", num_hats);
+          printf("Number of Balls:   %2d\n", num_balls);
+        }
+      }
+
+      printf("GameControllerConfig:\n");
+      if (!mapping)
       {
-        fprintf(stderr, "Unable to open joystick %d\n", joy_idx);
+        printf("  missing (see 'gamecontrollerdb.txt' or SDL_GAMECONTROLLERCONFIG)\n");
       }
       else
       {
-        SDL_GameController* gamepad = SDL_GameControllerOpen(joy_idx);
-        print_joystick_info(joy_idx, joy, gamepad);
-        if (gamepad)
+        printf("  Name:    '%s'\n", gamecontroller_name ? gamecontroller_name : "");
+        printf("  Mapping: '%s'\n", mapping);
+        SDL_free(mapping);
+      }
+      printf("\n");
+    }
+  }
+
+  if (opts->timing)
+  {
+    fprintf(stderr, "List: %d device(s), enumerate %.1f ms, query %.1f ms, open %.1f ms\n",
+            num_joysticks, enumerate_ms, query_ms, open_ms);
+  }
+}
+
+static int is_guid(const char* str)
+{
+  if (strlen(str) != MAPPING_GUID_LENGTH)
+  {
+    return 0;
+  }
+
+  for(const char* p = str; *p; ++p)
+  {
+    if (!isxdigit((unsigned char)*p))
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// --lookup, print the mapping of a GUID and what the GUID says about
+// the device, without SDL_Init() and without opening any device.
+// Returns 0 when every GUID had a mapping.
+int lookup_guid(const char* str, const MappingDB* dbs, int num_dbs, const Options* opts, int header)
+{
+  if (!is_guid(str))
+  {
+    fprintf(stderr, "Error: '%s' is not a GUID of %d hex digits\n", str, MAPPING_GUID_LENGTH);
+    return 1;
+  }
+
+  MappingLookup lookup;
+  mapping_lookup(&lookup, SDL_JoystickGetGUIDFromString(str), dbs, num_dbs);
+  mapping_lookup_print(&lookup, opts->format, header, stdout);
+  return lookup.mapping ? 0 : 1;
+}
+
+int lookup_guids(int num_guids, char** guids, const Options* opts)
+{
+  Uint64 start = SDL_GetPerformanceCounter();
+
+  // in the order of precedence: SDL registers SDL_GAMECONTROLLERCONFIG
+  // at user priority, which a mapping added through the API never
+  // replaces. SDL_GAMECONTROLLERCONFIG_FILE is read at API priority
+  // during SDL_Init(), so the gamecontrollerdb mappings that are added
+  // afterwards replace its mappings.
+  MappingDB dbs[3];
+  int num_dbs = 0;
+
+  const char* config = SDL_getenv("SDL_GAMECONTROLLERCONFIG");
+  if (config && *config)
+  {
+    mapping_db_load_string(&dbs[num_dbs++], "SDL_GAMECONTROLLERCONFIG", config);
+  }
+
+  if (mapping_db_open(&dbs[num_dbs], SDL2_JSTEST_DATADIR) == 0 ||
+      mapping_db_open(&dbs[num_dbs], ".") == 0)
+  {
+    num_dbs += 1;
+  }
+  else
+  {
+    fprintf(stderr, "error: failed to read gamecontrollerdb.txt: %s\n", SDL_GetError());
+  }
+
+  const char* config_file = SDL_getenv("SDL_GAMECONTROLLERCONFIG_FILE");
+  if (config_file && *config_file)
+  {
+    if (mapping_db_load(&dbs[num_dbs], config_file) == 0)
+    {
+      num_dbs += 1;
+    }
+    else
+    {
+      fprintf(stderr, "error: failed to read SDL_GAMECONTROLLERCONFIG_FILE: %s\n", SDL_GetError());
+    }
+  }
+
+  int ret = 0;
+  int count = 0;
+  for(int i = 0; i < num_guids; ++i)
+  {
+    if (strcmp(guids[i], "-") == 0)
+    {
+      // one GUID per line, e.g. grepped from a log
+      char line[256];
+      while (fgets(line, sizeof(line), stdin))
+      {
+        char* guid = line;
+        while (isspace((unsigned char)*guid))
+        {
+          guid += 1;
+        }
+        size_t len = strlen(guid);
+        while (len > 0 && isspace((unsigned char)guid[len - 1]))
+        {
+          guid[--len] = '\0';
+        }
+
+        if (len > 0)
         {
-          SDL_GameControllerClose(gamepad);
+          ret |= lookup_guid(guid, dbs, num_dbs, opts, count++ == 0);
         }
-        SDL_JoystickClose(joy);
       }
     }
+    else
+    {
+      ret |= lookup_guid(guids[i], dbs, num_dbs, opts, count++ == 0);
+    }
+  }
+
+  if (opts->timing)
+  {
+    fprintf(stderr, "Lookup: %.1f ms for %d GUID(s)\n", ms_since(start), count);
+  }
+
+  for(int i = 0; i < num_dbs; ++i)
+  {
+    mapping_db_free(&dbs[i]);
   }
+  return ret;
 }
 
-void test_joystick(int joy_idx)
+// Compact view of one joystick for a tile of the --test all layout,
+// everything that doesn't fit into the tile is cut off
+void draw_joystick_tile(WINDOW* win, Widgets* widgets, const JoystickState* state)
 {
-  SDL_Joystick* joy = SDL_JoystickOpen(joy_idx);
-  if (!joy)
+  static const char* hat_names[16] = {
+    "C", "N", "E", "NE", "S", "?", "SE", "?",
+    "W", "NW", "?", "?", "SW", "?", "?", "?"
+  };
+
+  int width = getmaxx(win) - 2;
+
+  werase(win);
+  box(win, 0, 0);
+  mvwprintw(win, 0, 2, " %d: %.*s ", state->joy_idx, SDL_max(width - 20, 1), state->name);
+  mvwprintw(win, 0, SDL_max(width - 10, 2), " %4.0f Hz ",
+            rate_estimator_live_rate(&state->rate, SDL_GetTicks()));
+
+  int y = 1;
+  widgets_resize(widgets, SDL_max(width - 13, 3));
+  for(int i = 0; i < state->num_axes; ++i, ++y)
   {
-    fprintf(stderr, "Unable to open joystick %d\n", joy_idx);
+    mvwprintw(win, y, 1, "A%-2d %6d ", i, state->axes[i]);
+    widget_bar(win, widgets, state->axes[i]);
+  }
+
+  if (state->num_buttons > 0)
+  {
+    char line[JOYSTICK_VIEW_TEXT_MAX];
+    int per_line = SDL_max(SDL_min(width - 4, JOYSTICK_VIEW_TEXT_MAX), 1);
+    for(int i = 0; i < state->num_buttons; i += per_line)
+    {
+      int n = SDL_min(per_line, state->num_buttons - i);
+      for(int j = 0; j < n; ++j)
+      {
+        line[j] = state->buttons[i + j] ? '#' : '.';
+      }
+      mvwaddstr(win, y, 1, i == 0 ? "B:  " : "    ");
+      waddnstr(win, line, n);
+      y += 1;
+    }
+  }
+
+  for(int i = 0; i < state->num_hats; ++i)
+  {
+    mvwprintw(win, y++, 1, "H%-2d %-2s", i, hat_names[state->hats[i] & 0x0f]);
+  }
+
+  for(int i = 0; i < state->num_balls; ++i)
+  {
+    mvwprintw(win, y++, 1, "b%-2d %6d %6d", i, state->balls[2*i+0], state->balls[2*i+1]);
+  }
+}
+
+// Lay the joysticks out in a grid of tiles, one line at the bottom is
+// left free for the status
+void layout_tiles(const JoystickStateList* list, WINDOW*** tiles, int* num_tiles)
+{
+  for(int i = 0; i < *num_tiles; ++i)
+  {
+    delwin((*tiles)[i]);
+  }
+  free(*tiles);
+
+  *num_tiles = list->count;
+  *tiles = calloc((size_t)SDL_max(list->count, 1), sizeof(WINDOW*));
+
+  if (list->count > 0)
+  {
+    int columns = SDL_min(SDL_max(COLS / 40, 1), list->count);
+    int rows = (list->count + columns - 1) / columns;
+    int tile_w = COLS / columns;
+    int tile_h = SDL_max((LINES - 1) / rows, 3);
+
+    for(int i = 0; i < list->count; ++i)
+    {
+      (*tiles)[i] = derwin(stdscr, tile_h, tile_w, (i / columns) * tile_h, (i % columns) * tile_w);
+    }
+  }
+}
+
+// Throw away whatever is on screen and lay it out again for the
+// current terminal size, either as tiles or as the body window of the
+// single joystick view with the footer below it
+void layout_screen(const JoystickStateList* list, int tiled,
+                   WINDOW*** tiles, int* num_tiles,
+                   WINDOW** body, JoystickView* view)
+{
+  clear();
+  joystick_view_invalidate(view);
+
+  if (tiled)
+  {
+    layout_tiles(list, tiles, num_tiles);
   }
   else
   {
-    initscr();
+    if (*body)
+    {
+      delwin(*body);
+    }
+    *body = derwin(stdscr, SDL_max(LINES - FOOTER_LINES, 2), COLS, 0, 0);
+  }
+}
 
-    //cbreak();
-    noecho();
-    nodelay(stdscr, TRUE);
-    //nonl();
-    curs_set(0);
+// Shared between the ingest loop of test_joystick(), which runs on the
+// main thread as that is where SDL pumps its events, and the render
+// thread, which owns curses
+typedef struct
+{
+  SDL_mutex* mutex;
+  SDL_cond* cond;
+
+  const Options* opts;
+  int joy_idx;
+
+  // only changed by the ingest loop and only with the mutex held
+  JoystickManager manager;
+  unsigned long serial;        // bumped on every change of the joysticks
+  unsigned long layout_serial; // bumped when joysticks got added or removed
+  unsigned long events;
+  double wakeups_per_sec;
+  double cpu_percent;
+
+  int quit;
+} TestShared;
+
+// Coalesce everything the ingest loop did since the last frame into one
+// frame, but don't draw more often than --fps allows
+int render_thread(void* userdata)
+{
+  TestShared* shared = userdata;
+  const Options* opts = shared->opts;
+  int tiled = shared->joy_idx == JOYSTICK_ALL;
+  const char* loop_mode = opts->wait ? "wait" : "poll";
+  Uint32 interval = (Uint32)(1000 / opts->fps);
+
+  // the joysticks as of the last frame, so that drawing doesn't block
+  // the ingest loop
+  JoystickStateList snapshot;
+  joystick_state_list_init(&snapshot);
+  // start out different from the ingest loop to get a first frame
+  unsigned long drawn_serial = ~0UL;
+  unsigned long drawn_layout = ~0UL;
+  unsigned long connects = 0;
+  unsigned long disconnects = 0;
+  double wakeups_per_sec = 0.0;
+  double cpu_percent = 0.0;
+
+  WINDOW** tiles = NULL;
+  int num_tiles = 0;
+  WINDOW* body = NULL;
+  Widgets tile_widgets;
+  widgets_init(&tile_widgets);
+
+  // only what changed gets written to the screen, the cells written
+  // per frame are averaged over one second like the other statistics
+  JoystickView view;
+  joystick_view_init(&view);
+  view.bounce_ms = opts->bounce_ms;
+  unsigned long frame_cells = 0;
+  double cells_per_frame = 0.0;
+
+  Uint32 window_start = SDL_GetTicks();
+  unsigned long window_events = 0;
+  unsigned long window_frames = 0;
+  double ingest_rate = 0.0;
+  double frame_rate = 0.0;
+
+  Uint32 last_frame = window_start - interval;
+  int redraw = 1;
+  int quit = 0;
 
-    int num_axes    = SDL_JoystickNumAxes(joy);
-    if (num_axes < 0) {
-      fprintf(stderr, "Unable to get SDL axes count: %s\n", SDL_GetError());
-      exit(EXIT_FAILURE);
+  while(!quit)
+  {
+    SDL_LockMutex(shared->mutex);
+    if (!redraw && shared->serial == drawn_serial && !shared->quit)
+    {
+      // wake up regularly anyway for the keyboard and the statistics
+      SDL_CondWaitTimeout(shared->cond, shared->mutex, RENDER_IDLE_TIMEOUT);
     }
 
-    int num_buttons = SDL_JoystickNumButtons(joy);
-    if (num_buttons < 0) {
-      fprintf(stderr, "Unable to get SDL buttons count: %s\n", SDL_GetError());
-      exit(EXIT_FAILURE);
+    Uint32 now = SDL_GetTicks();
+    if (now - last_frame < interval)
+    {
+      SDL_UnlockMutex(shared->mutex);
+      SDL_Delay(interval - (now - last_frame));
+      SDL_LockMutex(shared->mutex);
+      now = SDL_GetTicks();
     }
 
-    int num_hats    = SDL_JoystickNumHats(joy);
-    if (num_hats < 0) {
-      fprintf(stderr, "Unable to get SDL hats count: %s\n", SDL_GetError());
-      exit(EXIT_FAILURE);
+    // the axis sparklines move with time even when nothing happens,
+    // only the ones that changed get drawn
+    if (!tiled && now - last_frame >= RENDER_IDLE_TIMEOUT)
+    {
+      redraw = 1;
     }
 
-    int num_balls   = SDL_JoystickNumBalls(joy);
-    if (num_balls < 0) {
-      fprintf(stderr, "Unable to get SDL balls count: %s\n", SDL_GetError());
-      exit(EXIT_FAILURE);
+    if (now - window_start >= 1000)
+    {
+      Uint32 elapsed = now - window_start;
+      ingest_rate = (double)(shared->events - window_events) * 1000.0 / elapsed;
+      frame_rate = (double)window_frames * 1000.0 / elapsed;
+      cells_per_frame = window_frames ? (double)frame_cells / (double)window_frames : 0.0;
+
+      window_start = now;
+      window_events = shared->events;
+      window_frames = 0;
+      frame_cells = 0;
+      redraw = 1;
     }
 
-    Sint16* axes    = calloc((size_t)num_axes,    sizeof(Sint16));
-    Uint8*  buttons = calloc((size_t)num_buttons, sizeof(Uint8));
-    Uint8*  hats    = calloc((size_t)num_hats,    sizeof(Uint8));
-    Sint16*  balls   = calloc((size_t)num_balls,   2*sizeof(Sint16));
+    if (shared->serial != drawn_serial)
+    {
+      joystick_state_list_copy(&snapshot, &shared->manager.list);
+      drawn_serial = shared->serial;
+      redraw = 1;
+    }
 
-    int quit = 0;
-    SDL_Event event;
-    while(!quit)
+    int relayout = shared->layout_serial != drawn_layout;
+    drawn_layout = shared->layout_serial;
+    connects = shared->manager.connects;
+    disconnects = shared->manager.disconnects;
+    wakeups_per_sec = shared->wakeups_per_sec;
+    cpu_percent = shared->cpu_percent;
+    quit = shared->quit;
+    SDL_UnlockMutex(shared->mutex);
+
+    if (relayout)
+    {
+      layout_screen(&snapshot, tiled, &tiles, &num_tiles, &body, &view);
+    }
+
+    if (redraw && !quit)
     {
-      SDL_Delay(10);
+      char line[JOYSTICK_VIEW_TEXT_MAX];
 
-      bool something_new = FALSE;
-      while (SDL_PollEvent(&event)) {
-        something_new = TRUE;
-        switch(event.type)
+      if (tiled)
+      {
+        for(int i = 0; i < num_tiles; ++i)
         {
-          case SDL_JOYAXISMOTION:
-            assert(event.jaxis.axis < num_axes);
-            axes[event.jaxis.axis] = event.jaxis.value;
-            break;
-
-          case SDL_JOYBUTTONDOWN:
-          case SDL_JOYBUTTONUP:
-            assert(event.jbutton.button < num_buttons);
-            buttons[event.jbutton.button] = event.jbutton.state;
-            break;
-
-          case SDL_JOYHATMOTION:
-            assert(event.jhat.hat < num_hats);
-            hats[event.jhat.hat] = event.jhat.value;
-            break;
-
-          case SDL_JOYBALLMOTION:
-            assert(event.jball.ball < num_balls);
-            balls[2*event.jball.ball + 0] = event.jball.xrel;
-            balls[2*event.jball.ball + 1] = event.jball.yrel;
-            break;
-
-          case SDL_QUIT:
-            quit = 1;
-            printf("Recieved interrupt, exiting\n");
-            break;
+          draw_joystick_tile(tiles[i], &tile_widgets, snapshot.states[i]);
+          wnoutrefresh(tiles[i]);
+        }
 
-          default:
-            fprintf(stderr, "Error: Unhandled event type: %d\n", event.type);
+        snprintf(line, sizeof(line), "Ingest: %7.1f ev/s  Render: %5.1f/%d fps  Loop: %s %6.1f/s CPU %5.2f%%  Hotplug: +%lu -%lu  Ctrl-c exits",
+                 ingest_rate, frame_rate, opts->fps,
+                 loop_mode, wakeups_per_sec, cpu_percent,
+                 connects, disconnects);
+        joystick_view_text(&view, stdscr, 1, LINES - 1, line);
+      }
+      else
+      {
+        joystick_view_begin(&view);
+        if (snapshot.count > 0)
+        {
+          joystick_view_draw(&view, body, snapshot.states[0]);
+        }
+        else
+        {
+          snprintf(line, sizeof(line), "Joystick %d was disconnected, waiting for it to come back", shared->joy_idx);
+          joystick_view_text(&view, body, JOYSTICK_VIEW_SLOT_HEADER, 0, line);
         }
+        wnoutrefresh(body);
+
+        int y = LINES - FOOTER_LINES;
+        snprintf(line, sizeof(line), "Ingest: %7.1f events/s   Render: %5.1f/%d fps, %6.1f cells/frame",
+                 ingest_rate, frame_rate, opts->fps, cells_per_frame);
+        joystick_view_text(&view, stdscr, 1, y, line);
+        snprintf(line, sizeof(line), "Loop: %s, %6.1f wakeups/s, CPU %5.2f%%   Hotplug: %lu added, %lu removed",
+                 loop_mode, wakeups_per_sec, cpu_percent, connects, disconnects);
+        joystick_view_text(&view, stdscr, 2, y + 1, line);
+        snprintf(line, sizeof(line), "Lines %d-%d of %d, scroll with Up/Down/PgUp/PgDn/Home/End   Press Ctrl-c to exit",
+                 SDL_min(view.scroll + 1, view.end_y), SDL_min(view.scroll + view.height, view.end_y), view.end_y);
+        joystick_view_text(&view, stdscr, 3, y + 2, line);
+
+        frame_cells += view.cells;
       }
 
-      if (something_new)
-      {
-        //clear();
-        move(0,0);
+      refresh();
 
-        printw("Joystick Name:   '%s'\n", SDL_JoystickName(joy));
-        printw("Joystick Number: %d\n", joy_idx);
-        printw("\n");
+      window_frames += 1;
+      last_frame = now;
+      redraw = 0;
+    }
 
-        printw("Axes %2d:\n", num_axes);
-        for(int i = 0; i < num_axes; ++i)
+    int ch;
+    while ((ch = getch()) != ERR)
+    {
+      if (ch == 3) // Ctrl-c
+      {
+        // the ingest loop only wakes up for SDL events
+        SDL_Event event;
+        memset(&event, 0, sizeof(event));
+        event.type = SDL_QUIT;
+        SDL_PushEvent(&event);
+      }
+      else if (ch == KEY_RESIZE)
+      {
+        layout_screen(&snapshot, tiled, &tiles, &num_tiles, &body, &view);
+        redraw = 1;
+      }
+      else if (!tiled)
+      {
+        int lines = 0;
+        switch(ch)
         {
-          int len = COLS - 20;
-          printw("  %2d: %6d  ", i, axes[i]);
-          print_bar((axes[i] + 32767) * (len-1) / 65534, len);
-          addch('\n');
+          case KEY_UP:    case 'k': lines = -1; break;
+          case KEY_DOWN:  case 'j': lines = 1; break;
+          case KEY_PPAGE: lines = -view.height; break;
+          case KEY_NPAGE: lines = view.height; break;
+          case KEY_HOME:  lines = -view.end_y; break;
+          case KEY_END:   lines = view.end_y; break;
         }
-        printw("\n");
 
-        printw("Buttons %2d:\n", num_buttons);
-        for(int i = 0; i < num_buttons; ++i)
+        if (lines)
         {
-          printw("  %2d: %d  %s\n", i, buttons[i], buttons[i] ? "[#]":"[ ]");
+          joystick_view_scroll(&view, lines);
+          redraw = 1;
         }
-        printw("\n");
+      }
+    }
+  }
 
-        printw("Hats %2d:\n", num_hats);
-        for(int i = 0; i < num_hats; ++i)
-        {
-          printw("  %2d: value: %d\n", i, hats[i]);
-          printw("  +-----+  up:    %c\n"
-                 "  |%c %c %c|  down:  %c\n"
-                 "  |%c %c %c|  left:  %c\n"
-                 "  |%c %c %c|  right: %c\n"
-                 "  +-----+\n",
+  for(int i = 0; i < num_tiles; ++i)
+  {
+    delwin(tiles[i]);
+  }
+  free(tiles);
+  if (body)
+  {
+    delwin(body);
+  }
+  widgets_free(&tile_widgets);
+  joystick_view_free(&view);
+  joystick_state_list_free(&snapshot);
+
+  return 0;
+}
+
+// Sleep for up to timeout_ms and return the next event, if any.
+// SDL_WaitEventTimeout() can't be used for this, once a joystick is
+// open it wakes up every millisecond to pump it. *backoff is the
+// adaptive sleep of --wait, it starts at WAIT_TIMEOUT_MIN, doubles on
+// every wakeup without an event and drops back when one arrives. With
+// terminal, input on the terminal ends the sleep early.
+int wait_event(SDL_Event* event, int* backoff, int timeout_ms, int terminal)
+{
+  if (!SDL_PollEvent(event))
+  {
+    int sleep_ms = SDL_max(SDL_min(*backoff, timeout_ms), 1);
+    if (terminal)
+    {
+      wait_for_terminal(sleep_ms);
+    }
+    else
+    {
+      SDL_Delay((Uint32)sleep_ms);
+    }
 
-                 (hats[i] & SDL_HAT_UP)?'1':'0',
+    if (!SDL_PollEvent(event))
+    {
+      *backoff = SDL_min(*backoff * 2, WAIT_TIMEOUT_MAX);
+      return 0;
+    }
+  }
 
-                 ((hats[i] & SDL_HAT_UP) && (hats[i] & SDL_HAT_LEFT)) ? 'O' : ' ',
-                 ((hats[i] & SDL_HAT_UP) && !(hats[i] & (SDL_HAT_LEFT | SDL_HAT_RIGHT))) ? 'O' : ' ',
-                 ((hats[i] & SDL_HAT_UP) && (hats[i] & SDL_HAT_RIGHT)) ? 'O' : ' ',
+  *backoff = WAIT_TIMEOUT_MIN;
+  return 1;
+}
 
-                 (hats[i] & SDL_HAT_DOWN)?'1':'0',
+// Apply one event to the joysticks, returns 1 on SDL_QUIT
+int ingest_event(TestShared* shared, const SDL_Event* event, Recorder* recorder)
+{
+  shared->events += 1;
 
-                 (!(hats[i] & (SDL_HAT_UP | SDL_HAT_DOWN)) && (hats[i] & SDL_HAT_LEFT)) ? 'O' : ' ',
-                 (!(hats[i] & (SDL_HAT_UP | SDL_HAT_DOWN)) && !(hats[i] & (SDL_HAT_LEFT | SDL_HAT_RIGHT))) ? 'O' : ' ',
-                 (!(hats[i] & (SDL_HAT_UP | SDL_HAT_DOWN)) && (hats[i] & SDL_HAT_RIGHT)) ? 'O' : ' ',
+  if (recorder)
+  {
+    recorder_add(recorder, event);
+  }
 
-                 (hats[i] & SDL_HAT_LEFT)?'1':'0',
+  SDL_JoystickID which = joystick_event_which(event);
+  if (which >= 0)
+  {
+    // events of joysticks that aren't tested are dropped
+    JoystickState* state = joystick_state_list_find(&shared->manager.list, which);
+    if (state)
+    {
+      rate_estimator_add(&state->rate, event->common.timestamp);
+      joystick_state_handle_event(state, event);
+    }
+    return 0;
+  }
 
-                 ((hats[i] & SDL_HAT_DOWN) && (hats[i] & SDL_HAT_LEFT)) ? 'O' : ' ',
-                 ((hats[i] & SDL_HAT_DOWN) && !(hats[i] & (SDL_HAT_LEFT | SDL_HAT_RIGHT))) ? 'O' : ' ',
-                 ((hats[i] & SDL_HAT_DOWN) && (hats[i] & SDL_HAT_RIGHT)) ? 'O' : ' ',
+  switch(event->type)
+  {
+    case SDL_JOYDEVICEADDED:
+    case SDL_JOYDEVICEREMOVED:
+      if (joystick_manager_handle_event(&shared->manager, event))
+      {
+        shared->layout_serial += 1;
+      }
+      return 0;
 
-                 (hats[i] & SDL_HAT_RIGHT)?'1':'0');
-        }
-        printw("\n");
+    case SDL_QUIT:
+      return 1;
 
-        printw("Balls %2d: ", num_balls);
-        for(int i = 0; i < num_balls; ++i)
+    default:
+      fprintf(stderr, "Error: Unhandled event type: %d\n", event->type);
+      return 0;
+  }
+}
+
+// The values every axis reported during --test, an axis that claims
+// 16bit but only moves in big steps shows up here
+void print_axis_resolution(const JoystickStateList* list, FILE* out)
+{
+  for(int i = 0; i < list->count; ++i)
+  {
+    const JoystickState* state = list->states[i];
+    if (state->num_axes > 0)
+    {
+      fprintf(out, "\nAxis resolution of joystick %d '%s':\n", state->joy_idx, state->name);
+      axis_resolution_print(&state->resolution, out);
+    }
+  }
+}
+
+// Bounce summary of every joystick, with only_bounced the ones without
+// bounces are left out
+void print_button_bounce(const JoystickStateList* list, int threshold_ms, int only_bounced, FILE* out)
+{
+  for(int i = 0; i < list->count; ++i)
+  {
+    const JoystickState* state = list->states[i];
+    if (!only_bounced || button_bounce_total(&state->bounce, threshold_ms) > 0)
+    {
+      fprintf(out, "\nButton bounce of joystick %d '%s', threshold %d ms:\n",
+              state->joy_idx, state->name, threshold_ms);
+      button_bounce_print(&state->bounce, threshold_ms, out);
+    }
+  }
+}
+
+// --test without curses, everything goes into the joystick state like
+// with the curses view, but instead of drawing it a snapshot of every
+// joystick is written to stdout every --interval milliseconds
+void headless_joystick(TestShared* shared, Recorder* recorder)
+{
+  const Options* opts = shared->opts;
+  Uint32 interval = (Uint32)opts->interval;
+  Uint32 next = SDL_GetTicks();
+  unsigned long snapshots = 0;
+
+  LoopStats stats;
+  loop_stats_init(&stats, next);
+
+  int quit = 0;
+  int backoff = WAIT_TIMEOUT_MIN;
+  while(!quit)
+  {
+    Uint32 now = SDL_GetTicks();
+    if ((Sint32)(now - next) >= 0)
+    {
+      for(int i = 0; i < shared->manager.list.count; ++i)
+      {
+        const JoystickState* state = shared->manager.list.states[i];
+        int ok = opts->binary ?
+          snapshot_write_binary(stdout, now, state) :
+          snapshot_write_text(stdout, now, state);
+        if (!ok)
         {
-          printw("  %2d: %6d %6d\n", i, balls[2*i+0], balls[2*i+1]);
+          // the reader went away
+          quit = 1;
         }
-        printw("\n");
-        printw("\n");
-        printw("Press Ctrl-c to exit\n");
+      }
+      fflush(stdout);
+      snapshots += 1;
 
-        refresh();
+      // skip snapshots that were missed instead of catching up
+      next += interval;
+      if ((Sint32)(now - next) >= 0)
+      {
+        next = now + interval;
       }
+      continue;
+    }
 
-      if ( getch() == 3 ) // Ctrl-c
+    SDL_Event event;
+    if (wait_event(&event, &backoff, (int)(next - now), 0))
+    {
+      do
       {
-        quit = 1;
+        quit = ingest_event(shared, &event, recorder);
       }
-    } // while
+      while (!quit && SDL_PollEvent(&event));
+    }
+    loop_stats_wakeup(&stats, SDL_GetTicks());
+  }
 
-    free(balls);
-    free(hats);
-    free(buttons);
-    free(axes);
+  // stdout belongs to the snapshots
+  fprintf(stderr, "Wrote %lu snapshots\n", snapshots);
+  loop_stats_print(&stats, "headless", SDL_GetTicks(), stderr);
+  print_axis_resolution(&shared->manager.list, stderr);
+  print_button_bounce(&shared->manager.list, opts->bounce_ms, 1, stderr);
+}
 
-    endwin();
+void test_joystick(int joy_idx, const Options* opts)
+{
+  TestShared shared;
+  memset(&shared, 0, sizeof(shared));
+  shared.opts = opts;
+  shared.joy_idx = joy_idx;
+
+  // with 'all' joysticks that get plugged in later show up too, so
+  // starting without any is fine, unless there is something to record
+  if (joystick_manager_init(&shared.manager, joy_idx) == 0 &&
+      (joy_idx != JOYSTICK_ALL || opts->record_file))
+  {
+    if (joy_idx == JOYSTICK_ALL)
+    {
+      fprintf(opts->headless ? stderr : stdout, "No joysticks were found\n");
+    }
   }
+  else
+  {
+    Recorder* recorder = NULL;
+    if (opts->record_file)
+    {
+      recorder = recorder_open(opts->record_file, shared.manager.list.states[0]->joy);
+      if (!recorder)
+      {
+        joystick_manager_free(&shared.manager);
+        return;
+      }
+    }
+
+    if (opts->headless)
+    {
+      headless_joystick(&shared, recorder);
+      if (recorder)
+      {
+        recorder_close(recorder);
+      }
+      joystick_manager_free(&shared.manager);
+      return;
+    }
+
+    initscr();
+
+    //cbreak();
+    noecho();
+    nodelay(stdscr, TRUE);
+    //nonl();
+    curs_set(0);
+    keypad(stdscr, TRUE);
+
+    shared.mutex = SDL_CreateMutex();
+    shared.cond = SDL_CreateCond();
+    SDL_Thread* thread = SDL_CreateThread(render_thread, "render", &shared);
+    if (!thread)
+    {
+      endwin();
+      fprintf(stderr, "Unable to create render thread: %s\n", SDL_GetError());
+    }
+    else
+    {
+      const char* loop_mode = opts->wait ? "wait" : "poll";
+      LoopStats stats;
+      loop_stats_init(&stats, SDL_GetTicks());
+
+      int quit = 0;
+      int backoff = WAIT_TIMEOUT_MIN;
+      while(!quit)
+      {
+        SDL_Event event;
+        int got_event;
+        if (opts->wait)
+        {
+          // the render thread owns the terminal and pushes SDL_QUIT
+          got_event = wait_event(&event, &backoff, WAIT_TIMEOUT_MAX, 0);
+        }
+        else
+        {
+          SDL_Delay(10);
+          got_event = SDL_PollEvent(&event);
+        }
+
+        int new_window = loop_stats_wakeup(&stats, SDL_GetTicks());
+
+        if (got_event || new_window)
+        {
+          SDL_LockMutex(shared.mutex);
+          if (got_event)
+          {
+            // drain the whole queue, the render thread only sees the
+            // result
+            do
+            {
+              quit = ingest_event(&shared, &event, recorder);
+            }
+            while (!quit && SDL_PollEvent(&event));
+
+            shared.serial += 1;
+          }
+          shared.wakeups_per_sec = stats.wakeups_per_sec;
+          shared.cpu_percent = stats.cpu_percent;
+          shared.quit = quit;
+          SDL_CondSignal(shared.cond);
+          SDL_UnlockMutex(shared.mutex);
+        }
+      }
+
+      SDL_WaitThread(thread, NULL);
+      endwin();
+
+      printf("Recieved interrupt, exiting\n");
+      loop_stats_print(&stats, loop_mode, SDL_GetTicks(), stdout);
+      print_axis_resolution(&shared.manager.list, stdout);
+      print_button_bounce(&shared.manager.list, opts->bounce_ms, 1, stdout);
+    }
+
+    SDL_DestroyCond(shared.cond);
+    SDL_DestroyMutex(shared.mutex);
+
+    if (recorder)
+    {
+      recorder_close(recorder);
+    }
+  }
+
+  joystick_manager_free(&shared.manager);
 }
 
-void test_gamecontroller_events(SDL_GameController* gamepad)
+void test_gamecontroller_events(SDL_GameController* gamepad, const Options* opts)
 {
   assert(gamepad);
 
-  printf("Entering gamecontroller test loop, press Ctrl-c to exit\n");
+  fprintf(opts->format == OUTPUT_TEXT ? stdout : stderr,
+          "Entering gamecontroller test loop, press Ctrl-c to exit\n");
+  Output* output = output_open(opts->format, stdout);
   int quit = 0;
   SDL_Event event;
 
@@ -351,198 +1335,603 @@ void test_gamecontroller_events(SDL_GameController* gamepad)
         //       event.jball.which, event.jball.ball, event.jball.xrel, event.jball.yrel);
         break;
 
-      case SDL_JOYDEVICEADDED:
-        //printf("SDL_JOYDEVICEADDED which:%d\n", event.jdevice.which);
-        break;
+      case SDL_JOYDEVICEADDED:
+        //printf("SDL_JOYDEVICEADDED which:%d\n", event.jdevice.which);
+        break;
+
+      case SDL_JOYDEVICEREMOVED:
+        //printf("SDL_JOYDEVICEREMOVED which:%d\n", event.jdevice.which);
+        break;
+
+      case SDL_CONTROLLERAXISMOTION:
+      case SDL_CONTROLLERBUTTONDOWN:
+      case SDL_CONTROLLERBUTTONUP:
+      case SDL_CONTROLLERDEVICEADDED:
+      case SDL_CONTROLLERDEVICEREMOVED:
+      case SDL_CONTROLLERDEVICEREMAPPED:
+        output_event(output, &event);
+        break;
+
+      case SDL_QUIT:
+        quit = 1;
+        output_message(output, "Recieved interrupt, exiting\n");
+        break;
+
+      case SDL_KEYMAPCHANGED:
+        break;
+
+      default:
+        fprintf(stderr, "Error: Unhandled event type: %#x\n", event.type);
+        break;
+    }
+  }
+
+  output_close(output);
+}
+
+void test_gamecontroller_state(SDL_GameController* gamepad, int idx, const Options* opts)
+{
+  assert(gamepad);
+
+  GameControllerView view;
+  gamecontroller_view_init(&view, gamepad, idx);
+
+  initscr();
+
+  //cbreak();
+  noecho();
+  nodelay(stdscr, TRUE);
+  //nonl();
+  curs_set(0);
+  keypad(stdscr, TRUE);
+
+  Uint32 frame_ms = (Uint32)(1000 / opts->fps);
+  Uint32 last_frame = SDL_GetTicks() - frame_ms;
+  int dirty = 1;
+  int quit = 0;
+  int backoff = WAIT_TIMEOUT_MIN;
+
+  while(!quit)
+  {
+    int ch;
+    while ((ch = getch()) != ERR)
+    {
+      if (ch == 3) // Ctrl-c
+      {
+        quit = 1;
+      }
+      else if (ch == KEY_RESIZE)
+      {
+        clear();
+        gamecontroller_view_invalidate(&view);
+        dirty = 1;
+      }
+    }
+
+    // changes are collected until the next frame is due, so a
+    // controller streaming axis motion costs at most --fps redraws
+    Uint32 now = SDL_GetTicks();
+    if (dirty && now - last_frame >= frame_ms)
+    {
+      gamecontroller_view_draw(&view, stdscr);
+      refresh();
+      last_frame = now;
+      dirty = 0;
+    }
+
+    int timeout = dirty ? (int)(frame_ms - (now - last_frame)) : WAIT_TIMEOUT_MAX;
+    SDL_Event event;
+    if (!quit && wait_event(&event, &backoff, timeout, 1))
+    {
+      do
+      {
+        if (event.type == SDL_QUIT)
+        {
+          quit = 1;
+        }
+        else if (gamecontroller_view_handle_event(&view, &event))
+        {
+          dirty = 1;
+        }
+      }
+      while (SDL_PollEvent(&event));
+    }
+  }
+
+  endwin();
+  printf("Recieved interrupt, exiting\n");
+
+  gamecontroller_view_free(&view);
+}
+
+void test_gamecontroller(int gamecontroller_idx, const Options* opts)
+{
+  SDL_GameController* gamepad = SDL_GameControllerOpen(gamecontroller_idx);
+  if (!gamepad)
+  {
+    printf("error: not a gamecontroller\n");
+  }
+  else
+  {
+    if (opts->format_set)
+    {
+      test_gamecontroller_events(gamepad, opts);
+    }
+    else
+    {
+      test_gamecontroller_state(gamepad, gamecontroller_idx, opts);
+    }
+
+    SDL_GameControllerClose(gamepad);
+  }
+}
+
+void event_joystick(int joy_idx, const Options* opts)
+{
+  // hotplug events are only printed here, the list of joysticks stays
+  // the one from startup
+  JoystickManager manager;
+  const JoystickStateList* list = &manager.list;
+
+  if (joystick_manager_init(&manager, joy_idx) == 0)
+  {
+    if (joy_idx == JOYSTICK_ALL)
+    {
+      printf("No joysticks were found\n");
+    }
+  }
+  else
+  {
+    Recorder* recorder = NULL;
+    if (opts->record_file)
+    {
+      // a recording only describes one joystick, the events of the
+      // others end up in it too, but won't be replayed
+      recorder = recorder_open(opts->record_file, list->states[0]->joy);
+      if (!recorder)
+      {
+        joystick_manager_free(&manager);
+        return;
+      }
+    }
+
+    // the gamecontrollers are only opened to get SDL_CONTROLLER* events
+    // into the latency statistics
+    SDL_GameController** gamepads = calloc((size_t)list->count, sizeof(SDL_GameController*));
+    LatencyStats* latency = NULL;
+    if (opts->latency)
+    {
+      latency = malloc(sizeof(LatencyStats));
+      latency_stats_init(latency);
+      for(int i = 0; i < list->count; ++i)
+      {
+        if (SDL_IsGameController(list->states[i]->joy_idx))
+        {
+          gamepads[i] = SDL_GameControllerOpen(list->states[i]->joy_idx);
+        }
+      }
+    }
+
+    // the measuring modes and recording don't print the events, as
+    // that would slow down the loop to the speed of the terminal
+    int quiet = latency || opts->rate || opts->bounce || recorder;
+
+    // keep csv and jsonl output free of anything but events
+    if (quiet || opts->format == OUTPUT_TEXT)
+    {
+      for(int i = 0; i < list->count; ++i)
+      {
+        print_joystick_info(list->states[i]->joy_idx, list->states[i]->joy, gamepads[i]);
+      }
+    }
+
+    if (latency)
+    {
+      printf("Measuring event latency, press Ctrl-c to exit and print the summary\n");
+    }
+    else if (opts->rate)
+    {
+      printf("Measuring report rate, keep the joystick moving, press Ctrl-c to exit and print the summary\n");
+    }
+    else if (opts->bounce)
+    {
+      printf("Watching for button bounces shorter than %d ms, press every button a few times,\n"
+             "press Ctrl-c to exit and print the summary\n", opts->bounce_ms);
+    }
+    else if (recorder)
+    {
+      printf("Recording events to '%s', press Ctrl-c to stop\n", opts->record_file);
+    }
+    else
+    {
+      fprintf(opts->format == OUTPUT_TEXT ? stdout : stderr,
+              "Entering joystick test loop, press Ctrl-c to exit\n");
+    }
 
-      case SDL_JOYDEVICEREMOVED:
-        //printf("SDL_JOYDEVICEREMOVED which:%d\n", event.jdevice.which);
-        break;
+    Output* output = quiet ? NULL : output_open(opts->format, stdout);
 
-      case SDL_CONTROLLERAXISMOTION:
-        printf("SDL_CONTROLLERAXISMOTION controller: %d axis: %-12s value: %d\n",
-               event.caxis.which,
-          SDL_GameControllerGetStringForAxis(event.caxis.axis),
-               event.caxis.value);
-        break;
+    EventIngest ingest;
+    ingest.list = list;
+    ingest.recorder = recorder;
+    ingest.latency = latency;
+    ingest.output = output;
 
-      case SDL_CONTROLLERBUTTONDOWN:
-        printf("SDL_CONTROLLERBUTTONDOWN controller: %d button: %s state: %d\n",
-               event.cbutton.which,
-               SDL_GameControllerGetStringForButton(event.cbutton.button),
-               event.cbutton.state);
-        break;
+    int quit = 0;
+    SDL_Event event;
 
-      case SDL_CONTROLLERBUTTONUP:
-        printf("SDL_CONTROLLERBUTTONUP   controller: %d button: %s state: %d\n",
-               event.cbutton.which,
-               SDL_GameControllerGetStringForButton(event.cbutton.button),
-               event.cbutton.state);
-        break;
+    while(!quit && SDL_WaitEvent(&event))
+    {
+      quit = event_ingest(&ingest, &event);
+    }
 
-      case SDL_CONTROLLERDEVICEADDED:
-        printf("SDL_CONTROLLERDEVICEADDED which:%d\n", event.cdevice.which);
-        break;
+    if (output)
+    {
+      output_close(output);
+    }
 
-      case SDL_CONTROLLERDEVICEREMOVED:
-        printf("SDL_CONTROLLERDEVICEREMOVED which:%d\n",  event.cdevice.which);
-        break;
+    if (latency)
+    {
+      printf("\n");
+      latency_stats_print(latency, stdout);
+      free(latency);
+    }
 
-      case SDL_CONTROLLERDEVICEREMAPPED:
-        printf("SDL_CONTROLLERDEVICEREMAPPED which:%d\n", event.cdevice.which);
-        break;
+    if (opts->rate)
+    {
+      for(int i = 0; i < list->count; ++i)
+      {
+        printf("\nReport rate of joystick %d '%s':\n",
+               list->states[i]->joy_idx, SDL_JoystickName(list->states[i]->joy));
+        rate_estimator_print(&list->states[i]->rate, stdout);
+      }
+    }
 
-      case SDL_QUIT:
-        quit = 1;
-        printf("Recieved interrupt, exiting\n");
-        break;
+    if (opts->bounce)
+    {
+      print_button_bounce(list, opts->bounce_ms, 0, stdout);
+    }
 
-      case SDL_KEYMAPCHANGED:
-        break;
+    if (recorder)
+    {
+      recorder_close(recorder);
+    }
 
-      default:
-        fprintf(stderr, "Error: Unhandled event type: %#x\n", event.type);
-        break;
+    for(int i = 0; i < list->count; ++i)
+    {
+      if (gamepads[i])
+      {
+        SDL_GameControllerClose(gamepads[i]);
+      }
     }
+    free(gamepads);
   }
+
+  joystick_manager_free(&manager);
 }
 
-void test_gamecontroller_state(SDL_GameController* gamepad)
+// Seed the statistics of a phase with the current position of every
+// axis, an axis that doesn't move at all still gets a sample
+static void calibration_begin(Calibration* cals, const JoystickStateList* list, CalibrationPhase phase)
 {
-  assert(gamepad);
+  for(int i = 0; i < list->count; ++i)
+  {
+    for(int axis = 0; axis < list->states[i]->num_axes; ++axis)
+    {
+      calibration_add(&cals[i], phase, axis, list->states[i]->axes[axis]);
+    }
+  }
+}
 
-  printf("Entering gamecontroller test loop, press Ctrl-c to exit\n");
-  int quit = 0;
-  SDL_Event event;
+void calibrate_joystick(int joy_idx, const Options* opts)
+{
+  JoystickManager manager;
+  const JoystickStateList* list = &manager.list;
 
-  while(!quit && SDL_WaitEvent(&event))
+  if (joystick_manager_init(&manager, joy_idx) == 0)
   {
-    switch(event.type)
+    if (joy_idx == JOYSTICK_ALL)
     {
-      case SDL_QUIT:
-        quit = 1;
-        printf("Recieved interrupt, exiting\n");
-        break;
+      fprintf(stderr, "No joysticks were found\n");
+    }
+  }
+  else
+  {
+    Calibration* cals = calloc((size_t)list->count, sizeof(Calibration));
+    for(int i = 0; i < list->count; ++i)
+    {
+      calibration_init(&cals[i], list->states[i]->num_axes);
     }
 
-    for(int btn = 0; btn < SDL_CONTROLLER_BUTTON_MAX; ++btn)
+    // prompts go to stderr, so the report can be redirected
+    CalibrationPhase phase = CALIBRATION_REST;
+    Uint32 phase_end = SDL_GetTicks() + CALIBRATE_REST_MS;
+    fprintf(stderr, "Don't touch the joystick for %d seconds, measuring the resting noise...\n",
+            CALIBRATE_REST_MS / 1000);
+    calibration_begin(cals, list, phase);
+
+    int quit = 0;
+    while(!quit)
     {
-      printf("%s:%d ",
-             SDL_GameControllerGetStringForButton(btn),
-             SDL_GameControllerGetButton(gamepad, btn));
+      Uint32 now = SDL_GetTicks();
+      if ((Sint32)(now - phase_end) >= 0)
+      {
+        if (phase == CALIBRATION_SWEEP)
+        {
+          break;
+        }
+
+        phase = CALIBRATION_SWEEP;
+        phase_end = now + CALIBRATE_SWEEP_MS;
+        fprintf(stderr, "Now move every stick and trigger to its limits, in circles for sticks,\n"
+                        "for %d seconds or until Ctrl-c...\n", CALIBRATE_SWEEP_MS / 1000);
+        calibration_begin(cals, list, phase);
+        continue;
+      }
+
+      SDL_Event event;
+      if (SDL_WaitEventTimeout(&event, (int)(phase_end - now)))
+      {
+        do
+        {
+          if (event.type == SDL_QUIT)
+          {
+            quit = 1;
+          }
+          else if (event.type == SDL_JOYAXISMOTION)
+          {
+            for(int i = 0; i < list->count; ++i)
+            {
+              if (list->states[i]->id == event.jaxis.which)
+              {
+                JoystickState* state = list->states[i];
+                joystick_state_handle_event(state, &event);
+                calibration_add(&cals[i], phase, event.jaxis.axis, state->axes[event.jaxis.axis]);
+              }
+            }
+          }
+        }
+        while (!quit && SDL_PollEvent(&event));
+      }
     }
 
-    for(int axis = 0; axis < SDL_CONTROLLER_AXIS_MAX; ++axis)
+    if (quit && phase == CALIBRATION_REST)
     {
-      printf("%s:%6d ",
-             SDL_GameControllerGetStringForAxis(axis),
-             SDL_GameControllerGetAxis(gamepad, axis));
+      fprintf(stderr, "Interrupted while measuring the resting noise, the outer deadzones are unknown\n");
     }
 
-    printf("\n");
+    for(int i = 0; i < list->count; ++i)
+    {
+      if (opts->format == OUTPUT_TEXT && i > 0)
+      {
+        printf("\n");
+      }
+      calibration_print(&cals[i], list->states[i]->joy_idx, list->states[i]->name,
+                        opts->format, i == 0, stdout);
+      calibration_free(&cals[i]);
+    }
+    free(cals);
   }
+
+  joystick_manager_free(&manager);
 }
 
-void test_gamecontroller(int gamecontroller_idx)
+// Draw the title, the polar plot and the numbers of a stick at y, x.
+// shown holds the plot lines on screen and is only rewritten where
+// the plot changed.
+void draw_stick(int y, int x, int idx, const StickGate* gate, char* shown, int full)
 {
-  SDL_GameController* gamepad = SDL_GameControllerOpen(gamecontroller_idx);
-  if (!gamepad)
+  char plot[STICK_PLOT_HEIGHT * (STICK_PLOT_WIDTH + 1)];
+  stick_gate_plot(gate, plot, STICK_PLOT_WIDTH, STICK_PLOT_HEIGHT);
+
+  if (full)
   {
-    printf("error: not a gamecontroller\n");
+    mvprintw(y, x, "Stick %d: axes %d and %d", idx, gate->x_axis, gate->y_axis);
   }
-  else
-  {
-    //test_gamecontroller_events(gamepad);
-    test_gamecontroller_state(gamepad);
 
-    SDL_GameControllerClose(gamepad);
+  for(int row = 0; row < STICK_PLOT_HEIGHT; ++row)
+  {
+    char* line = plot + row * (STICK_PLOT_WIDTH + 1);
+    char* old = shown + row * (STICK_PLOT_WIDTH + 1);
+    if (full || strcmp(line, old) != 0)
+    {
+      mvaddstr(y + 1 + row, x, line);
+      memcpy(old, line, STICK_PLOT_WIDTH + 1);
+    }
   }
+
+  StickGateInfo info;
+  stick_gate_analyze(gate, &info);
+  mvprintw(y + 2 + STICK_PLOT_HEIGHT, x, "Sectors: %2d/%-2d  Error: %5.1f%%  ",
+           info.covered, STICK_SECTORS, info.circularity_error);
+  mvprintw(y + 3 + STICK_PLOT_HEIGHT, x, "Radius: %5.3f - %5.3f  ", info.min_radius, info.max_radius);
+  mvprintw(y + 4 + STICK_PLOT_HEIGHT, x, "Outer deadzone: %5.1f%%  ", info.outer_deadzone * 100.0);
 }
 
-void event_joystick(int joy_idx)
+void stick_joystick(int joy_idx, const Options* opts)
 {
-  SDL_Joystick* joy = SDL_JoystickOpen(joy_idx);
-  if (!joy)
+  JoystickState* state = joystick_state_open(joy_idx);
+  if (!state)
   {
     fprintf(stderr, "Unable to open joystick %d\n", joy_idx);
+    return;
   }
-  else
+
+  if (state->num_axes < 2)
   {
-    print_joystick_info(joy_idx, joy, NULL);
+    fprintf(stderr, "Error: joystick %d has less than two axes\n", joy_idx);
+    joystick_state_close(state);
+    return;
+  }
 
-    printf("Entering joystick test loop, press Ctrl-c to exit\n");
-    int quit = 0;
-    SDL_Event event;
+  // the stick each axis belongs to, -1 for none
+  int* stick_of_axis = malloc((size_t)state->num_axes * sizeof(int));
+  for(int i = 0; i < state->num_axes; ++i)
+  {
+    stick_of_axis[i] = -1;
+  }
 
-    while(!quit && SDL_WaitEvent(&event))
+  for(int i = 0; i < 2 * opts->num_sticks; ++i)
+  {
+    int axis = opts->stick_axes[i];
+    if (axis >= state->num_axes || stick_of_axis[axis] >= 0)
     {
-      switch(event.type)
-      {
-        case SDL_JOYAXISMOTION:
-          printf("SDL_JOYAXISMOTION: joystick: %d axis: %d value: %d\n",
-                 event.jaxis.which, event.jaxis.axis, event.jaxis.value);
-          break;
+      fprintf(stderr, "Error: axis %d doesn't exist or is used twice in --sticks\n", axis);
+      free(stick_of_axis);
+      joystick_state_close(state);
+      return;
+    }
+    stick_of_axis[axis] = i / 2;
+  }
 
-        case SDL_JOYBUTTONDOWN:
-          printf("SDL_JOYBUTTONDOWN: joystick: %d button: %d state: %d\n",
-                 event.jbutton.which, event.jbutton.button, event.jbutton.state);
-          break;
+  StickGate gates[MAX_STICKS];
+  int num_sticks = opts->num_sticks;
+  for(int i = 0; i < num_sticks; ++i)
+  {
+    stick_gate_init(&gates[i], opts->stick_axes[2 * i], opts->stick_axes[2 * i + 1]);
+  }
 
-        case SDL_JOYBUTTONUP:
-          printf("SDL_JOYBUTTONUP: joystick: %d button: %d state: %d\n",
-                 event.jbutton.which, event.jbutton.button, event.jbutton.state);
-          break;
+  // without --sticks the first seconds are spent on finding the sticks
+  StickPairing pairing;
+  int detecting = num_sticks == 0;
+  Uint32 detect_end = SDL_GetTicks() + STICK_DETECT_MS;
+  stick_pairing_init(&pairing, detecting ? state->num_axes : 0);
 
-        case SDL_JOYHATMOTION:
-          printf("SDL_JOYHATMOTION: joystick: %d hat: %d value: %d\n",
-                 event.jhat.which, event.jhat.hat, event.jhat.value);
-          break;
+  static char shown[MAX_STICKS][STICK_PLOT_HEIGHT * (STICK_PLOT_WIDTH + 1)];
 
-        case SDL_JOYBALLMOTION:
-          printf("SDL_JOYBALLMOTION: joystick: %d ball: %d x: %d y: %d\n",
-                 event.jball.which, event.jball.ball, event.jball.xrel, event.jball.yrel);
-          break;
+  initscr();
 
-        case SDL_JOYDEVICEADDED:
-          printf("SDL_JOYDEVICEADDED which:%d\n", event.jdevice.which);
-          break;
+  //cbreak();
+  noecho();
+  nodelay(stdscr, TRUE);
+  //nonl();
+  curs_set(0);
+  keypad(stdscr, TRUE);
 
-        case SDL_JOYDEVICEREMOVED:
-          printf("SDL_JOYDEVICEREMOVED which:%d\n", event.jdevice.which);
-          break;
+  Uint32 frame_ms = (Uint32)(1000 / opts->fps);
+  Uint32 last_frame = SDL_GetTicks() - frame_ms;
+  int full = 1;
+  int dirty = 1;
+  int quit = 0;
+  int backoff = WAIT_TIMEOUT_MIN;
 
-        case SDL_CONTROLLERBUTTONDOWN:
-          printf("SDL_CONTROLLERBUTTONDOWN\n");
-          break;
+  while(!quit)
+  {
+    int ch;
+    while ((ch = getch()) != ERR)
+    {
+      if (ch == 3) // Ctrl-c
+      {
+        quit = 1;
+      }
+      else if (ch == KEY_RESIZE)
+      {
+        full = 1;
+        dirty = 1;
+      }
+    }
 
-        case SDL_CONTROLLERBUTTONUP:
-          printf("SDL_CONTROLLERBUTTONUP\n");
-          break;
+    Uint32 now = SDL_GetTicks();
+    if (detecting && (Sint32)(now - detect_end) >= 0)
+    {
+      int axes[2 * MAX_STICKS];
+      num_sticks = stick_pairing_detect(&pairing, axes, MAX_STICKS);
+      for(int i = 0; i < num_sticks; ++i)
+      {
+        stick_gate_init(&gates[i], axes[2 * i], axes[2 * i + 1]);
+        stick_of_axis[axes[2 * i]] = i;
+        stick_of_axis[axes[2 * i + 1]] = i;
+      }
+      detecting = 0;
+      full = 1;
+      dirty = 1;
+    }
 
-        case SDL_CONTROLLERDEVICEADDED:
-          printf("SDL_CONTROLLERDEVICEADDED which:%d\n", event.cdevice.which);
-          break;
+    if (detecting)
+    {
+      // the countdown has to move even when nothing happens
+      dirty = 1;
+    }
 
-        case SDL_CONTROLLERDEVICEREMOVED:
-          printf("SDL_CONTROLLERDEVICEREMOVED which:%d\n",  event.cdevice.which);
-          break;
+    if (dirty && now - last_frame >= frame_ms)
+    {
+      if (full)
+      {
+        clear();
+        mvprintw(0, 0, "Joystick Name:   '%s'", state->name);
+      }
 
-        case SDL_CONTROLLERDEVICEREMAPPED:
-          printf("SDL_CONTROLLERDEVICEREMAPPED which:%d\n", event.cdevice.which);
-          break;
+      if (detecting)
+      {
+        mvprintw(2, 0, "Move every stick in circles, detecting which axes belong together... %2u s ",
+                 (detect_end - now + 999) / 1000);
+      }
+      else
+      {
+        int columns = SDL_max(COLS / (STICK_PLOT_WIDTH + 3), 1);
+        for(int i = 0; i < num_sticks; ++i)
+        {
+          draw_stick(2 + (i / columns) * (STICK_PLOT_HEIGHT + 6),
+                     (i % columns) * (STICK_PLOT_WIDTH + 3),
+                     i, &gates[i], shown[i], full);
+        }
+      }
 
-        case SDL_QUIT:
-          quit = 1;
-          printf("Recieved interrupt, exiting\n");
-          break;
+      refresh();
+      last_frame = now;
+      full = 0;
+      dirty = 0;
+    }
 
-        default:
-          fprintf(stderr, "Error: Unhandled event type: %d\n", event.type);
-          break;
+    int timeout = dirty ? (int)(frame_ms - (now - last_frame)) : WAIT_TIMEOUT_MAX;
+    SDL_Event event;
+    if (!quit && wait_event(&event, &backoff, timeout, 1))
+    {
+      do
+      {
+        if (event.type == SDL_QUIT)
+        {
+          quit = 1;
+        }
+        else if (event.type == SDL_JOYAXISMOTION &&
+                 event.jaxis.which == state->id &&
+                 joystick_state_handle_event(state, &event))
+        {
+          int axis = event.jaxis.axis;
+          if (detecting)
+          {
+            stick_pairing_add(&pairing, axis, event.jaxis.timestamp);
+          }
+          else if (stick_of_axis[axis] >= 0)
+          {
+            StickGate* gate = &gates[stick_of_axis[axis]];
+            stick_gate_add(gate, state->axes[gate->x_axis], state->axes[gate->y_axis]);
+            dirty = 1;
+          }
+        }
       }
+      while (SDL_PollEvent(&event));
+    }
+  }
+
+  endwin();
+  printf("Recieved interrupt, exiting\n");
+
+  if (detecting)
+  {
+    printf("Interrupted while detecting the sticks\n");
+  }
+  else
+  {
+    printf("\nStick gates of joystick %d '%s':\n", joy_idx, state->name);
+    for(int i = 0; i < num_sticks; ++i)
+    {
+      stick_gate_print(&gates[i], stdout);
     }
-    SDL_JoystickClose(joy);
   }
+
+  stick_pairing_free(&pairing);
+  free(stick_of_axis);
+  joystick_state_close(state);
 }
 
 void test_rumble(int joy_idx)
@@ -586,18 +1975,58 @@ void test_rumble(int joy_idx)
 
 int main(int argc, char** argv)
 {
-  if (argc == 1)
+  Options opts = { 0 };
+  opts.replay_speed = 1.0;
+  opts.fps = DEFAULT_FPS;
+  opts.interval = DEFAULT_INTERVAL;
+  opts.bounce_ms = DEFAULT_BOUNCE_MS;
+  argc = extract_options(argc, argv, &opts);
+
+  if (argc == 1 && !opts.replay_file && !opts.virtual_spec && !opts.timing)
   {
     print_help(argv[0]);
     exit(1);
   }
+  else if (argc == 2 && (strcmp(argv[1], "--help") == 0 ||
+                         strcmp(argv[1], "-h") == 0))
+  {
+    print_help(argv[0]);
+    exit(EXIT_SUCCESS);
+  }
+  else if (argc == 2 && (strcmp(argv[1], "--version") == 0))
+  {
+    printf("sdl2-jstest " SDL_JSTEST_VERSION "\n");
+    exit(EXIT_SUCCESS);
+  }
+  else if (argc >= 3 && strcmp(argv[1], "--lookup") == 0)
+  {
+    exit(lookup_guids(argc - 2, argv + 2, &opts));
+  }
+
+  Uint64 start = SDL_GetPerformanceCounter();
 
   // SDL2 will only report events when the window has focus, so set
   // this hint as we don't have a window
   SDL_SetHint(SDL_HINT_JOYSTICK_ALLOW_BACKGROUND_EVENTS, "1");
 
-  // FIXME: We don't need video, but without it SDL will fail to work in SDL_WaitEvent()
-  if(SDL_Init(SDL_INIT_TIMER | SDL_INIT_VIDEO | SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER | SDL_INIT_HAPTIC) < 0)
+  // setting the filter after SDL_Init() would flush the added events
+  // of the connected devices, it finds nothing until the mappings are
+  // loaded and those devices get theirs from mapping_db_add_present()
+  MappingDB mappings;
+  memset(&mappings, 0, sizeof(mappings));
+  mapping_db_watch(&mappings);
+
+  // --list only looks at the joysticks, it doesn't need to connect to
+  // the display or scan for haptic devices
+  Uint32 subsystems = SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER;
+  if (!(argc == 2 && (strcmp(argv[1], "--list") == 0 || strcmp(argv[1], "-l") == 0)) ||
+      opts.replay_file || opts.virtual_spec)
+  {
+    // FIXME: We don't need video, but without it SDL will fail to work in SDL_WaitEvent()
+    subsystems |= SDL_INIT_TIMER | SDL_INIT_VIDEO | SDL_INIT_HAPTIC;
+  }
+
+  if(SDL_Init(subsystems) < 0)
   {
     fprintf(stderr, "Unable to init SDL: %s\n", SDL_GetError());
     exit(1);
@@ -605,33 +2034,78 @@ int main(int argc, char** argv)
   else
   {
     atexit(SDL_Quit);
+    double init_ms = ms_since(start);
+
+    // only the mappings of the connected devices are registered, the
+    // rest when their device shows up
+    Uint64 mappings_start = SDL_GetPerformanceCounter();
+    int ret = mapping_db_open(&mappings, SDL2_JSTEST_DATADIR);
+    if (ret < 0) {
+      ret = mapping_db_open(&mappings, ".");
+    }
+
+    if (ret < 0)
+    {
+      fprintf(stderr, "error: failed to read gamecontrollerdb.txt: %s\n", SDL_GetError());
+    }
+    else
+    {
+      mapping_db_add_present(&mappings);
+    }
+
+    if (opts.timing)
+    {
+      fprintf(stderr, "Startup: %.1f ms (SDL_Init %.1f ms, mappings %.1f ms)\n",
+              ms_since(start), init_ms, ms_since(mappings_start));
+      if (ret == 0)
+      {
+        fprintf(stderr, "Mappings: %d registered, %d of %d lines for %s in %s\n",
+                mappings.registered, mappings.num_entries, mappings.num_lines,
+                SDL_GetPlatform(), mappings.source);
+      }
+    }
 
+    Replay* replay = NULL;
+    if (opts.replay_file)
     {
-      int ret = SDL_GameControllerAddMappingsFromFile(SDL2_JSTEST_DATADIR "/gamecontrollerdb.txt");
-      if (ret < 0) {
-        ret = SDL_GameControllerAddMappingsFromFile("gamecontrollerdb.txt");
+      replay = replay_open(opts.replay_file, opts.replay_speed);
+      if (!replay)
+      {
+        exit(1);
       }
+    }
 
-      if (ret < 0)
+    Generator* generator = NULL;
+    if (opts.virtual_spec)
+    {
+      generator = generator_open(opts.virtual_spec);
+      if (!generator)
       {
-        fprintf(stderr, "error: failed to read gamecontrollerdb.txt: %s\n", SDL_GetError());
+        if (replay)
+        {
+          replay_close(replay);
+        }
+        exit(1);
       }
     }
 
-    if (argc == 2 && (strcmp(argv[1], "--help") == 0 ||
-                      strcmp(argv[1], "-h") == 0))
+    if (argc == 1 && replay)
+    {
+      event_joystick(replay_device_index(replay), &opts);
+    }
+    else if (argc == 1 && generator)
     {
-      print_help(argv[0]);
+      event_joystick(generator_count(generator) == 1 ? generator_device_index(generator, 0) : JOYSTICK_ALL,
+                     &opts);
     }
-    else if (argc == 2 && (strcmp(argv[1], "--version") == 0))
+    else if (argc == 1)
     {
-      printf("sdl2-jstest " SDL_JSTEST_VERSION "\n");
-      exit(EXIT_SUCCESS);
+      // --timing on its own, the startup is all there is to time
     }
     else if (argc == 2 && (strcmp(argv[1], "--list") == 0 ||
                            (strcmp(argv[1], "-l") == 0)))
     {
-      list_joysticks();
+      list_joysticks(&opts);
     }
     else if (argc == 3 && (strcmp(argv[1], "--gamecontroller") == 0 ||
                            strcmp(argv[1], "-g") == 0))
@@ -644,25 +2118,46 @@ int main(int argc, char** argv)
       }
       else
       {
-        test_gamecontroller(idx);
+        test_gamecontroller(idx, &opts);
       }
     }
     else if (argc == 3 && (strcmp(argv[1], "--test") == 0 ||
                            strcmp(argv[1], "-t") == 0))
     {
       int joy_idx;
-      if (!str2int(argv[2], &joy_idx))
+      if (!str2joystick(argv[2], &joy_idx))
       {
-        fprintf(stderr, "Error: JOYSTICKNUM argument must be a number, but was '%s'\n", argv[2]);
+        fprintf(stderr, "Error: JOYSTICKNUM argument must be a number or 'all', but was '%s'\n", argv[2]);
         exit(1);
       }
       else
       {
-        test_joystick(joy_idx);
+        test_joystick(joy_idx, &opts);
       }
     }
     else if (argc == 3 && (strcmp(argv[1], "--event") == 0 ||
                            strcmp(argv[1], "-e") == 0))
+    {
+      int joy_idx;
+      if (!str2joystick(argv[2], &joy_idx))
+      {
+        fprintf(stderr, "Error: JOYSTICKNUM argument must be a number or 'all', but was '%s'\n", argv[2]);
+        exit(1);
+      }
+      event_joystick(joy_idx, &opts);
+    }
+    else if (argc == 3 && strcmp(argv[1], "--latency") == 0)
+    {
+      int joy_idx;
+      if (!str2joystick(argv[2], &joy_idx))
+      {
+        fprintf(stderr, "Error: JOYSTICKNUM argument must be a number or 'all', but was '%s'\n", argv[2]);
+        exit(1);
+      }
+      opts.latency = 1;
+      event_joystick(joy_idx, &opts);
+    }
+    else if (argc == 3 && strcmp(argv[1], "--stick") == 0)
     {
       int joy_idx;
       if (!str2int(argv[2], &joy_idx))
@@ -670,7 +2165,39 @@ int main(int argc, char** argv)
         fprintf(stderr, "Error: JOYSTICKNUM argument must be a number, but was '%s'\n", argv[2]);
         exit(1);
       }
-      event_joystick(joy_idx);
+      stick_joystick(joy_idx, &opts);
+    }
+    else if (argc == 3 && strcmp(argv[1], "--bounce") == 0)
+    {
+      int joy_idx;
+      if (!str2joystick(argv[2], &joy_idx))
+      {
+        fprintf(stderr, "Error: JOYSTICKNUM argument must be a number or 'all', but was '%s'\n", argv[2]);
+        exit(1);
+      }
+      opts.bounce = 1;
+      event_joystick(joy_idx, &opts);
+    }
+    else if (argc == 3 && strcmp(argv[1], "--calibrate") == 0)
+    {
+      int joy_idx;
+      if (!str2joystick(argv[2], &joy_idx))
+      {
+        fprintf(stderr, "Error: JOYSTICKNUM argument must be a number or 'all', but was '%s'\n", argv[2]);
+        exit(1);
+      }
+      calibrate_joystick(joy_idx, &opts);
+    }
+    else if (argc == 3 && strcmp(argv[1], "--rate") == 0)
+    {
+      int joy_idx;
+      if (!str2joystick(argv[2], &joy_idx))
+      {
+        fprintf(stderr, "Error: JOYSTICKNUM argument must be a number or 'all', but was '%s'\n", argv[2]);
+        exit(1);
+      }
+      opts.rate = 1;
+      event_joystick(joy_idx, &opts);
     }
     else if (argc == 3 && (strcmp(argv[1], "--rumble") == 0 ||
                            strcmp(argv[1], "-r") == 0))
@@ -691,6 +2218,19 @@ int main(int argc, char** argv)
       fprintf(stderr, "%s: unknown arguments\n", argv[0]);
       fprintf(stderr, "Try '%s --help' for more informations\n", argv[0]);
     }
+
+    if (generator)
+    {
+      generator_close(generator);
+    }
+
+    if (replay)
+    {
+      replay_close(replay);
+    }
+
+    mapping_db_unwatch(&mappings);
+    mapping_db_free(&mappings);
   }
 
   return EXIT_SUCCESS;
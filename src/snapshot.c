@@ -0,0 +1,117 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "snapshot.h"
+
+#include <stdlib.h>
+
+#include "byte_order.h"
+
+int snapshot_write_text(FILE* fp, Uint32 time, const JoystickState* state)
+{
+  static const char hex[] = "0123456789abcdef";
+
+  fprintf(fp, "time=%u joystick=%d axes=", time, state->joy_idx);
+  for(int i = 0; i < state->num_axes; ++i)
+  {
+    fprintf(fp, i ? ",%d" : "%d", state->axes[i]);
+  }
+
+  // most significant digit first, so the value reads like a number
+  fputs(" buttons=0x", fp);
+  int digits = (state->num_buttons + 3) / 4;
+  if (digits == 0)
+  {
+    fputc('0', fp);
+  }
+  for(int d = digits - 1; d >= 0; --d)
+  {
+    int nibble = 0;
+    for(int b = 0; b < 4; ++b)
+    {
+      int i = d * 4 + b;
+      if (i < state->num_buttons && state->buttons[i])
+      {
+        nibble |= 1 << b;
+      }
+    }
+    fputc(hex[nibble], fp);
+  }
+
+  fputs(" hats=", fp);
+  for(int i = 0; i < state->num_hats; ++i)
+  {
+    fprintf(fp, i ? ",%d" : "%d", state->hats[i]);
+  }
+
+  fputs(" balls=", fp);
+  for(int i = 0; i < 2 * state->num_balls; ++i)
+  {
+    fprintf(fp, i ? ",%d" : "%d", state->balls[i]);
+  }
+
+  return fputc('\n', fp) != EOF;
+}
+
+int snapshot_write_binary(FILE* fp, Uint32 time, const JoystickState* state)
+{
+  size_t button_bytes = ((size_t)state->num_buttons + 7) / 8;
+  size_t size = 4 + 4 + 4 * 2 +
+    (size_t)state->num_axes * 2 +
+    button_bytes +
+    (size_t)state->num_hats +
+    (size_t)state->num_balls * 4;
+
+  Uint8* record = calloc(size, 1);
+  Uint8* p = record;
+
+  p = put_u32(p, time);
+  p = put_u32(p, (Uint32)state->joy_idx);
+  p = put_u16(p, (Uint16)state->num_axes);
+  p = put_u16(p, (Uint16)state->num_buttons);
+  p = put_u16(p, (Uint16)state->num_hats);
+  p = put_u16(p, (Uint16)state->num_balls);
+
+  for(int i = 0; i < state->num_axes; ++i)
+  {
+    p = put_u16(p, (Uint16)state->axes[i]);
+  }
+
+  for(int i = 0; i < state->num_buttons; ++i)
+  {
+    if (state->buttons[i])
+    {
+      p[i / 8] |= (Uint8)(1 << (i % 8));
+    }
+  }
+  p += button_bytes;
+
+  for(int i = 0; i < state->num_hats; ++i)
+  {
+    *p++ = state->hats[i];
+  }
+
+  for(int i = 0; i < 2 * state->num_balls; ++i)
+  {
+    p = put_u16(p, (Uint16)state->balls[i]);
+  }
+
+  int ok = fwrite(record, size, 1, fp) == 1;
+  free(record);
+  return ok;
+}
+
+/* EOF */
@@ -0,0 +1,50 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_SNAPSHOT_H
+#define HEADER_SDL_JSTEST_SNAPSHOT_H
+
+#include <stdio.h>
+
+#include "joystick_state.h"
+
+// Compact dumps of the complete state of a joystick, written by
+// --test --headless every --interval milliseconds.
+//
+// Text, one line per joystick and snapshot:
+//
+//   time=1234 joystick=0 axes=0,-32768,127 buttons=0x05 hats=0,8 balls=0,0
+//
+// The buttons are a hex number with button 0 in the lowest bit.
+//
+// Binary, all little-endian, one record per joystick and snapshot:
+//
+//   Uint32  time
+//   Sint32  joystick number
+//   Uint16  number of axes, buttons, hats, balls
+//   Sint16  axes[number of axes]
+//   Uint8   buttons[(number of buttons + 7) / 8], button 0 is bit 0 of
+//           the first byte
+//   Uint8   hats[number of hats]
+//   Sint16  balls[2 * number of balls], x and y of each ball
+
+// Returns 0 when writing failed
+int snapshot_write_text(FILE* fp, Uint32 time, const JoystickState* state);
+int snapshot_write_binary(FILE* fp, Uint32 time, const JoystickState* state);
+
+#endif
+
+/* EOF */
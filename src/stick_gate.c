@@ -0,0 +1,290 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stick_gate.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#  define M_PI 3.14159265358979323846
+#endif
+
+// Radius at the edge of the polar plot, leaves room for the diagonals
+// of a square gate
+#define PLOT_RADIUS 1.5
+
+// Times two axes have to move together to be taken as a stick
+#define PAIRING_MIN_COUNT 10
+
+// Axes moving within this many milliseconds move together
+#define PAIRING_WINDOW_MS 2
+
+static double sector_angle(int sector)
+{
+  return -M_PI + (sector + 0.5) * 2.0 * M_PI / STICK_SECTORS;
+}
+
+static void plot_point(char* out, int width, int height, double x, double y, char ch)
+{
+  double cx = (width - 1) / 2.0;
+  double cy = (height - 1) / 2.0;
+  int col = (int)lround(cx + x * cx / PLOT_RADIUS);
+  int row = (int)lround(cy - y * cy / PLOT_RADIUS);
+
+  if (col >= 0 && col < width && row >= 0 && row < height)
+  {
+    out[row * (width + 1) + col] = ch;
+  }
+}
+
+void stick_gate_init(StickGate* gate, int x_axis, int y_axis)
+{
+  memset(gate, 0, sizeof(StickGate));
+  gate->x_axis = x_axis;
+  gate->y_axis = y_axis;
+}
+
+void stick_gate_add(StickGate* gate, int x, int y)
+{
+  // SDL axes point down, the plot points up
+  gate->x = x / 32767.0;
+  gate->y = -y / 32767.0;
+  gate->samples += 1;
+
+  double radius = sqrt(gate->x * gate->x + gate->y * gate->y);
+  if (radius >= STICK_MIN_RADIUS)
+  {
+    int sector = (int)((atan2(gate->y, gate->x) + M_PI) * STICK_SECTORS / (2.0 * M_PI));
+    if (sector >= STICK_SECTORS)
+    {
+      sector = 0;
+    }
+
+    if (radius > gate->max_radius[sector])
+    {
+      gate->max_radius[sector] = radius;
+      gate->changes += 1;
+    }
+  }
+}
+
+void stick_gate_analyze(const StickGate* gate, StickGateInfo* info)
+{
+  memset(info, 0, sizeof(StickGateInfo));
+
+  double sum = 0.0;
+  for(int i = 0; i < STICK_SECTORS; ++i)
+  {
+    double radius = gate->max_radius[i];
+    if (radius > 0.0)
+    {
+      if (info->covered == 0 || radius < info->min_radius)
+      {
+        info->min_radius = radius;
+      }
+      if (radius > info->max_radius)
+      {
+        info->max_radius = radius;
+      }
+      sum += radius;
+      info->covered += 1;
+    }
+  }
+
+  if (info->covered == 0)
+  {
+    return;
+  }
+
+  info->mean_radius = sum / info->covered;
+
+  double squares = 0.0;
+  for(int i = 0; i < STICK_SECTORS; ++i)
+  {
+    if (gate->max_radius[i] > 0.0)
+    {
+      double deviation = gate->max_radius[i] - info->mean_radius;
+      squares += deviation * deviation;
+    }
+  }
+  info->circularity_error = sqrt(squares / info->covered) * 100.0 / info->mean_radius;
+  info->outer_deadzone = info->min_radius < 1.0 ? 1.0 - info->min_radius : 0.0;
+}
+
+void stick_gate_plot(const StickGate* gate, char* out, int width, int height)
+{
+  for(int row = 0; row < height; ++row)
+  {
+    memset(out + row * (width + 1), ' ', (size_t)width);
+    out[row * (width + 1) + width] = '\0';
+  }
+
+  plot_point(out, width, height, 0.0, 0.0, '+');
+
+  int steps = 4 * (width + height);
+  for(int i = 0; i < steps; ++i)
+  {
+    double angle = i * 2.0 * M_PI / steps;
+    plot_point(out, width, height, cos(angle), sin(angle), '.');
+  }
+
+  for(int i = 0; i < STICK_SECTORS; ++i)
+  {
+    if (gate->max_radius[i] > 0.0)
+    {
+      double angle = sector_angle(i);
+      plot_point(out, width, height,
+                 gate->max_radius[i] * cos(angle), gate->max_radius[i] * sin(angle), '*');
+    }
+  }
+
+  plot_point(out, width, height, gate->x, gate->y, '@');
+}
+
+void stick_gate_print(const StickGate* gate, FILE* out)
+{
+  StickGateInfo info;
+  stick_gate_analyze(gate, &info);
+
+  fprintf(out, "  Stick with axes %d and %d: %u samples, %d of %d sectors reached\n",
+          gate->x_axis, gate->y_axis, gate->samples, info.covered, STICK_SECTORS);
+  if (info.covered == 0)
+  {
+    return;
+  }
+
+  fprintf(out, "    Radius:             min %.3f  mean %.3f  max %.3f\n",
+          info.min_radius, info.mean_radius, info.max_radius);
+  fprintf(out, "    Circularity error:  %.1f%%\n", info.circularity_error);
+  fprintf(out, "    Outer deadzone:     %.1f%%%s\n", info.outer_deadzone * 100.0,
+          info.covered < STICK_SECTORS ? " (not every direction was reached)" : "");
+
+  fprintf(out, "    Max radius per sector, counterclockwise from the right:\n");
+  for(int i = 0; i < STICK_SECTORS; ++i)
+  {
+    // sector 0 ends at -180 degrees, start from the one right of center
+    int sector = (i + STICK_SECTORS / 2) % STICK_SECTORS;
+    double degrees = sector_angle(sector) * 180.0 / M_PI;
+    if (degrees < 0.0)
+    {
+      degrees += 360.0;
+    }
+
+    fprintf(out, "%s%6.1f: %5.3f", i % 4 == 0 ? "     " : "   ", degrees, gate->max_radius[sector]);
+    if (i % 4 == 3)
+    {
+      fprintf(out, "\n");
+    }
+  }
+}
+
+void stick_pairing_init(StickPairing* pairing, int num_axes)
+{
+  pairing->num_axes = num_axes;
+  pairing->last_time = calloc((size_t)(num_axes > 0 ? num_axes : 1), sizeof(uint32_t));
+  pairing->together = calloc((size_t)(num_axes > 0 ? num_axes * num_axes : 1), sizeof(uint32_t));
+}
+
+void stick_pairing_free(StickPairing* pairing)
+{
+  free(pairing->last_time);
+  free(pairing->together);
+  pairing->last_time = NULL;
+  pairing->together = NULL;
+  pairing->num_axes = 0;
+}
+
+void stick_pairing_add(StickPairing* pairing, int axis, uint32_t time)
+{
+  for(int other = 0; other < pairing->num_axes; ++other)
+  {
+    if (other != axis &&
+        pairing->last_time[other] != 0 &&
+        time - pairing->last_time[other] <= PAIRING_WINDOW_MS)
+    {
+      int lo = axis < other ? axis : other;
+      int hi = axis < other ? other : axis;
+      pairing->together[lo * pairing->num_axes + hi] += 1;
+    }
+  }
+  // 0 marks an axis that never moved
+  pairing->last_time[axis] = time ? time : 1;
+}
+
+int stick_pairing_detect(const StickPairing* pairing, int* axes, int max_sticks)
+{
+  int n = pairing->num_axes;
+  char* used = calloc((size_t)(n > 0 ? n : 1), 1);
+  int sticks = 0;
+
+  // greedily take the pair that moved together most often
+  while (sticks < max_sticks)
+  {
+    uint32_t best = 0;
+    int best_lo = -1;
+    int best_hi = -1;
+    for(int lo = 0; lo < n; ++lo)
+    {
+      for(int hi = lo + 1; hi < n; ++hi)
+      {
+        uint32_t count = pairing->together[lo * n + hi];
+        if (!used[lo] && !used[hi] && count >= PAIRING_MIN_COUNT && count > best)
+        {
+          best = count;
+          best_lo = lo;
+          best_hi = hi;
+        }
+      }
+    }
+
+    if (best_lo < 0)
+    {
+      break;
+    }
+
+    used[best_lo] = used[best_hi] = 1;
+    axes[2 * sticks + 0] = best_lo;
+    axes[2 * sticks + 1] = best_hi;
+    sticks += 1;
+  }
+
+  // whatever is left gets paired in order
+  int pending = -1;
+  for(int axis = 0; axis < n && sticks < max_sticks; ++axis)
+  {
+    if (!used[axis])
+    {
+      if (pending < 0)
+      {
+        pending = axis;
+      }
+      else
+      {
+        axes[2 * sticks + 0] = pending;
+        axes[2 * sticks + 1] = axis;
+        sticks += 1;
+        pending = -1;
+      }
+    }
+  }
+
+  free(used);
+  return sticks;
+}
+
+/* EOF */
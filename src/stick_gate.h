@@ -0,0 +1,104 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_STICK_GATE_H
+#define HEADER_SDL_JSTEST_STICK_GATE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Angular sectors a stick is split into, 11.25 degrees each
+#define STICK_SECTORS 32
+
+// Samples closer to the center than this, as a fraction of full
+// deflection, say nothing about the gate and are only counted
+#define STICK_MIN_RADIUS 0.25
+
+// The shape of the gate of a stick, the furthest it got in each
+// direction. Radii are relative to full deflection on one axis, so a
+// round gate that reaches the edges is 1.0 everywhere and a square
+// one reaches 1.41 in the diagonals. Adding a sample is O(1).
+typedef struct
+{
+  int x_axis;
+  int y_axis;
+
+  uint32_t samples;
+  uint32_t changes;  // bumped whenever a sector got further out
+
+  // last position, normalized to -1..1, y pointing up
+  double x;
+  double y;
+
+  double max_radius[STICK_SECTORS];
+} StickGate;
+
+// What the gate of a stick looks like
+typedef struct
+{
+  int covered;         // sectors the stick got out into
+  double mean_radius;  // of the covered sectors
+  double min_radius;
+  double max_radius;
+
+  // root mean square deviation of the covered sectors from a circle
+  // of mean_radius, in percent of it
+  double circularity_error;
+
+  // how much of full deflection the weakest direction doesn't reach,
+  // the outer deadzone a game needs to get full deflection everywhere
+  double outer_deadzone;
+} StickGateInfo;
+
+void stick_gate_init(StickGate* gate, int x_axis, int y_axis);
+
+// Add a position, x and y are the raw axis values
+void stick_gate_add(StickGate* gate, int x, int y);
+
+void stick_gate_analyze(const StickGate* gate, StickGateInfo* info);
+
+// Render a polar plot of the gate into lines of width chars. Each
+// sector is marked with a '*' at its radius, the unit circle with '.'
+// and the current position with '@'. out needs height * (width + 1)
+// chars, every line is terminated with '\0'.
+void stick_gate_plot(const StickGate* gate, char* out, int width, int height);
+
+void stick_gate_print(const StickGate* gate, FILE* out);
+
+// Finds the axes that make up a stick by counting how often two axes
+// move at the same time, the axes of a stick that is moved in circles
+// report together all the time
+typedef struct
+{
+  int num_axes;
+  uint32_t* last_time;
+  uint32_t* together;  // num_axes * num_axes
+} StickPairing;
+
+void stick_pairing_init(StickPairing* pairing, int num_axes);
+void stick_pairing_free(StickPairing* pairing);
+
+void stick_pairing_add(StickPairing* pairing, int axis, uint32_t time);
+
+// Pair the axes that moved together most often, up to max_sticks pairs
+// of x and y axes are written to axes, returns the number of sticks.
+// Axes that didn't move together are paired in order, 0 with 1, 2
+// with 3 and so on.
+int stick_pairing_detect(const StickPairing* pairing, int* axes, int max_sticks);
+
+#endif
+
+/* EOF */
@@ -0,0 +1,159 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "widgets.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Space for one diagram including the line breaks
+#define HAT_GLYPH_SIZE 128
+
+// Diagrams for all 16 combinations of the hat bits, the impossible
+// ones included, so that any value can be looked up. Built on first use.
+static char hat_glyphs[16][HAT_GLYPH_SIZE];
+static int  hat_glyph_lens[16];
+
+// start and length of each line of a diagram, all diagrams have the
+// same shape so one table does for all of them
+static int  hat_line_starts[WIDGET_HAT_LINES];
+static int  hat_line_lens[WIDGET_HAT_LINES];
+static int  hat_glyphs_ready = 0;
+
+static void build_hat_glyphs(void)
+{
+  for(int value = 0; value < 16; ++value)
+  {
+    int up    = (value & WIDGET_HAT_UP) != 0;
+    int down  = (value & WIDGET_HAT_DOWN) != 0;
+    int left  = (value & WIDGET_HAT_LEFT) != 0;
+    int right = (value & WIDGET_HAT_RIGHT) != 0;
+    int vert  = up || down;
+    int horz  = left || right;
+
+    hat_glyph_lens[value] =
+      snprintf(hat_glyphs[value], HAT_GLYPH_SIZE,
+               "  +-----+  up:    %c\n"
+               "  |%c %c %c|  down:  %c\n"
+               "  |%c %c %c|  left:  %c\n"
+               "  |%c %c %c|  right: %c\n"
+               "  +-----+\n",
+
+               up ? '1' : '0',
+
+               (up && left) ? 'O' : ' ',
+               (up && !horz) ? 'O' : ' ',
+               (up && right) ? 'O' : ' ',
+
+               down ? '1' : '0',
+
+               (!vert && left) ? 'O' : ' ',
+               (!vert && !horz) ? 'O' : ' ',
+               (!vert && right) ? 'O' : ' ',
+
+               left ? '1' : '0',
+
+               (down && left) ? 'O' : ' ',
+               (down && !horz) ? 'O' : ' ',
+               (down && right) ? 'O' : ' ',
+
+               right ? '1' : '0');
+  }
+
+  int start = 0;
+  for(int line = 0; line < WIDGET_HAT_LINES; ++line)
+  {
+    const char* nl = strchr(hat_glyphs[0] + start, '\n');
+    hat_line_starts[line] = start;
+    hat_line_lens[line] = (int)(nl - (hat_glyphs[0] + start));
+    start += hat_line_lens[line] + 1;
+  }
+
+  hat_glyphs_ready = 1;
+}
+
+void widgets_init(Widgets* widgets)
+{
+  widgets->bar_len = 0;
+  widgets->bars = NULL;
+
+  if (!hat_glyphs_ready)
+  {
+    build_hat_glyphs();
+  }
+}
+
+void widgets_free(Widgets* widgets)
+{
+  free(widgets->bars);
+  widgets->bars = NULL;
+  widgets->bar_len = 0;
+}
+
+void widgets_resize(Widgets* widgets, int bar_len)
+{
+  if (bar_len < 1)
+  {
+    bar_len = 1;
+  }
+
+  if (bar_len != widgets->bar_len)
+  {
+    size_t stride = (size_t)bar_len + 2;
+
+    free(widgets->bars);
+    widgets->bar_len = bar_len;
+    widgets->bars = malloc((size_t)bar_len * stride);
+
+    for(int pos = 0; pos < bar_len; ++pos)
+    {
+      char* bar = widgets->bars + (size_t)pos * stride;
+      bar[0] = '[';
+      memset(bar + 1, ' ', (size_t)bar_len);
+      bar[1 + pos] = '#';
+      bar[stride - 1] = ']';
+    }
+  }
+}
+
+int widget_bar_pos(const Widgets* widgets, int value)
+{
+  return (value + 32767) * (widgets->bar_len - 1) / 65534;
+}
+
+int widget_bar(WINDOW* win, const Widgets* widgets, int value)
+{
+  int stride = widgets->bar_len + 2;
+  waddnstr(win, widgets->bars + (size_t)widget_bar_pos(widgets, value) * (size_t)stride, stride);
+  return stride;
+}
+
+int widget_hat(WINDOW* win, int value)
+{
+  value &= 0x0f;
+  waddnstr(win, hat_glyphs[value], hat_glyph_lens[value]);
+  return hat_glyph_lens[value];
+}
+
+int widget_hat_line(WINDOW* win, int value, int line)
+{
+  value &= 0x0f;
+  waddnstr(win, hat_glyphs[value] + hat_line_starts[line], hat_line_lens[line]);
+  return hat_line_lens[line];
+}
+
+/* EOF */
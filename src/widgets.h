@@ -0,0 +1,69 @@
+// sdl-jstest - Joystick Test Program for SDL
+// Copyright (C) 2014 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SDL_JSTEST_WIDGETS_H
+#define HEADER_SDL_JSTEST_WIDGETS_H
+
+#include <curses.h>
+
+// Hat bits, these are the values of SDL_HAT_* in SDL 1.2 and SDL2
+#define WIDGET_HAT_UP    0x01
+#define WIDGET_HAT_RIGHT 0x02
+#define WIDGET_HAT_DOWN  0x04
+#define WIDGET_HAT_LEFT  0x08
+
+// Lines of the hat diagram drawn by widget_hat()
+#define WIDGET_HAT_LINES 5
+
+// The axis bars and hat diagrams of the --test views as ready made
+// strings, so that drawing a widget is a single waddnstr() instead of
+// one waddch() per cell. The bars have to be rebuilt when the terminal
+// width changes, see widgets_resize().
+typedef struct
+{
+  int bar_len;
+
+  // one "[  #  ]" string of bar_len + 2 chars for every position of
+  // the '#', without terminating '\0'
+  char* bars;
+} Widgets;
+
+void widgets_init(Widgets* widgets);
+void widgets_free(Widgets* widgets);
+
+// Build the bars for bar_len cells between the brackets, does nothing
+// when they already have that length
+void widgets_resize(Widgets* widgets, int bar_len);
+
+// Cell of the '#' for an axis value from -32768 to 32767
+int widget_bar_pos(const Widgets* widgets, int value);
+
+// Draw the bar for an axis value at the cursor, returns the number of
+// cells written
+int widget_bar(WINDOW* win, const Widgets* widgets, int value);
+
+// Draw the diagram of a hat value at the cursor, it takes up
+// WIDGET_HAT_LINES lines starting at column 0. Returns the number of
+// cells written.
+int widget_hat(WINDOW* win, int value);
+
+// Draw only one line of the hat diagram at the cursor, without moving
+// to the next line
+int widget_hat_line(WINDOW* win, int value, int line);
+
+#endif
+
+/* EOF */